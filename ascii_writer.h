@@ -0,0 +1,83 @@
+#ifndef ASCII_WRITER_H
+#define ASCII_WRITER_H
+
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+
+// Escritor de texto con búfer para las nubes de puntos y mallas. Los números se
+// formatean igual que 'ostream << double' con la configuración por defecto (%g,
+// 6 cifras significativas), pero los enteros de menos de 7 cifras, que son casi
+// todas las coordenadas, se convierten a mano sin pasar por printf. El texto se
+// acumula en un búfer grande y se vuelca con pocas llamadas a write().
+class AsciiWriter {
+private:
+    std::ostream& out;
+    std::vector<char> buffer;
+    size_t used = 0;
+
+    // Asegurar espacio para 'bytes' caracteres más
+    void reserve(size_t bytes) {
+        if (used + bytes > buffer.size()) {
+            flush();
+            if (bytes > buffer.size()) buffer.resize(bytes);
+        }
+    }
+
+public:
+    explicit AsciiWriter(std::ostream& stream, size_t capacity = 1 << 20)
+        : out(stream), buffer(capacity) {}
+
+    ~AsciiWriter() {
+        flush();
+    }
+
+    AsciiWriter(const AsciiWriter&) = delete;
+    AsciiWriter& operator=(const AsciiWriter&) = delete;
+
+    void flush() {
+        if (used > 0) {
+            out.write(buffer.data(), used);
+            used = 0;
+        }
+    }
+
+    void put(char c) {
+        reserve(1);
+        buffer[used++] = c;
+    }
+
+    void text(const char* str) {
+        size_t length = std::strlen(str);
+        reserve(length);
+        std::memcpy(&buffer[used], str, length);
+        used += length;
+    }
+
+    void integer(long long value) {
+        reserve(21);
+        char digits[20];
+        int count = 0;
+        unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+        do {
+            digits[count++] = (char)('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude);
+        if (value < 0) buffer[used++] = '-';
+        while (count) buffer[used++] = digits[--count];
+    }
+
+    // Mismo texto que 'ostream << value' con precisión 6 y sin banderas
+    void number(double value) {
+        if (value == std::floor(value) && std::fabs(value) < 1e6 && !(value == 0 && std::signbit(value))) {
+            integer((long long)value);
+            return;
+        }
+        reserve(32);
+        used += std::snprintf(&buffer[used], 32, "%g", value);
+    }
+};
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef ASYNC_WRITER_H
+#define ASYNC_WRITER_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <ostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <algorithm>
+
+// Búfer de salida que entrega bloques llenos a un hilo escritor mediante una cola
+// acotada: quien escribe solo copia bytes al bloque actual y el disco trabaja en
+// paralelo. Si la cola está llena, quien escribe espera, así la memoria usada no
+// pasa de (maxQueued + 2) bloques (el que se llena, los encolados y el que está
+// escribiendo el hilo) sin importar cuántos datos se escriban.
+class AsyncWriteBuffer : public std::streambuf {
+private:
+    std::ostream& target;
+    const size_t chunkSize;
+    const size_t maxQueued;
+
+    std::vector<char> current;                 // Bloque que se está llenando
+    std::deque<std::vector<char>> queued;      // Bloques llenos pendientes de escribir
+    std::vector<std::vector<char>> spare;      // Bloques ya escritos, para reutilizar
+    std::mutex mutex;
+    std::condition_variable queueChanged;
+    bool closing = false;
+    bool failed = false;
+    size_t bytesWritten = 0;
+    std::thread worker;
+
+    void writerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            queueChanged.wait(lock, [&] { return closing || !queued.empty(); });
+            if (queued.empty()) break;
+
+            std::vector<char> chunk;
+            chunk.swap(queued.front());
+            queued.pop_front();
+            queueChanged.notify_all();
+
+            // Escribir sin el candado para que el productor siga llenando bloques
+            lock.unlock();
+            target.write(chunk.data(), (std::streamsize)chunk.size());
+            bool ok = target.good();
+            lock.lock();
+
+            failed = failed || !ok;
+            bytesWritten += chunk.size();
+            chunk.clear();
+            spare.push_back(std::move(chunk));
+        }
+    }
+
+    // Encolar el bloque actual (si tiene datos) y preparar uno nuevo
+    void submit() {
+        size_t used = pptr() - pbase();
+        if (used == 0) return;
+        current.resize(used);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        queueChanged.wait(lock, [&] { return queued.size() < maxQueued; });
+        queued.push_back(std::move(current));
+        if (!spare.empty()) {
+            current.swap(spare.back());
+            spare.pop_back();
+        } else {
+            current = std::vector<char>();
+        }
+        queueChanged.notify_all();
+        lock.unlock();
+
+        current.resize(chunkSize);
+        setp(current.data(), current.data() + current.size());
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        submit();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* data, std::streamsize count) override {
+        std::streamsize remaining = count;
+        while (remaining > 0) {
+            std::streamsize space = epptr() - pptr();
+            if (space == 0) {
+                submit();
+                continue;
+            }
+            std::streamsize n = std::min(space, remaining);
+            std::memcpy(pptr(), data, (size_t)n);
+            pbump((int)n);
+            data += n;
+            remaining -= n;
+        }
+        return count;
+    }
+
+public:
+    AsyncWriteBuffer(std::ostream& stream, size_t chunkBytes = 1 << 20, size_t queueDepth = 4)
+        : target(stream), chunkSize(chunkBytes), maxQueued(queueDepth), current(chunkBytes) {
+        setp(current.data(), current.data() + current.size());
+        worker = std::thread(&AsyncWriteBuffer::writerLoop, this);
+    }
+
+    ~AsyncWriteBuffer() override {
+        finish();
+    }
+
+    // Encolar lo pendiente, esperar al hilo escritor y devolver si todo se escribió
+    bool finish() {
+        if (worker.joinable()) {
+            submit();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closing = true;
+            }
+            queueChanged.notify_all();
+            worker.join();
+            target.flush();
+        }
+        return !failed && target.good();
+    }
+
+    size_t written() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return bytesWritten;
+    }
+};
+
+// Archivo de salida con escritura asíncrona: se usa como cualquier std::ostream y
+// close() espera a que el hilo escritor vacíe la cola
+class AsyncFileWriter : public std::ostream {
+private:
+    std::ofstream file;
+    AsyncWriteBuffer buffer;
+
+public:
+    explicit AsyncFileWriter(const std::string& filename, size_t chunkBytes = 1 << 20, size_t queueDepth = 4)
+        : std::ostream(nullptr), file(filename, std::ios::binary), buffer(file, chunkBytes, queueDepth) {
+        rdbuf(&buffer);
+        if (!file.is_open()) setstate(std::ios::badbit);
+    }
+
+    bool is_open() const { return file.is_open(); }
+
+    bool close() {
+        bool ok = buffer.finish() && good();
+        file.close();
+        return ok;
+    }
+};
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef BIT_VOLUME_H
+#define BIT_VOLUME_H
+
+#include <vector>
+#include <cstdint>
+#include <climits>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+#include "edge_kernels.h"
+
+// Vista de solo lectura de una imagen binaria empaquetada (1 bit por píxel)
+struct BitSliceView {
+    const uint64_t* data = nullptr;
+    int rows = 0;
+    int cols = 0;
+    int wordsPerRow = 0;
+
+    const uint64_t* row(int r) const {
+        return data + (size_t)r * wordsPerRow;
+    }
+
+    bool get(int r, int c) const {
+        return (row(r)[c >> 6] >> (c & 63)) & 1;
+    }
+};
+
+// Volumen binario empaquetado: las imágenes se guardan una tras otra, cada fila
+// ocupa wordsPerRow palabras de 64 bits. Ocupa 1/8 de lo que ocupan las mismas
+// imágenes como cv::Mat de 8 bits y las filas quedan contiguas en memoria.
+class BitVolume {
+private:
+    std::vector<uint64_t> bits;
+    int numSlices = 0;
+    int numRows = 0;
+    int numCols = 0;
+    int wordsPerRow = 0;
+
+public:
+    void create(int slices, int rows, int cols) {
+        numSlices = slices;
+        numRows = rows;
+        numCols = cols;
+        wordsPerRow = packedWords(cols);
+        bits.assign((size_t)slices * rows * wordsPerRow, 0);
+    }
+
+    void clear() {
+        std::vector<uint64_t>().swap(bits);
+        numSlices = numRows = numCols = wordsPerRow = 0;
+    }
+
+    bool empty() const { return numSlices == 0; }
+    int slices() const { return numSlices; }
+    int rows() const { return numRows; }
+    int cols() const { return numCols; }
+    int words() const { return wordsPerRow; }
+    size_t rowStride() const { return wordsPerRow; }
+    size_t sliceStride() const { return (size_t)numRows * wordsPerRow; }
+    size_t memoryBytes() const { return bits.size() * sizeof(uint64_t); }
+
+    uint64_t* sliceData(int z) { return bits.data() + z * sliceStride(); }
+    const uint64_t* sliceData(int z) const { return bits.data() + z * sliceStride(); }
+    uint64_t* rowData(int z, int r) { return sliceData(z) + (size_t)r * wordsPerRow; }
+    const uint64_t* rowData(int z, int r) const { return sliceData(z) + (size_t)r * wordsPerRow; }
+
+    BitSliceView slice(int z) const {
+        BitSliceView view;
+        view.data = sliceData(z);
+        view.rows = numRows;
+        view.cols = numCols;
+        view.wordsPerRow = wordsPerRow;
+        return view;
+    }
+
+    // Empaquetar una imagen de 8 bits (valores > threshold son objeto)
+    void packSlice(int z, const cv::Mat& image, uchar threshold = 0) {
+        for (int r = 0; r < numRows; r++) {
+            packRow(image.ptr<uchar>(r), numCols, rowData(z, r), threshold);
+        }
+    }
+};
+
+// Desempaquetar una imagen binaria a cv::Mat de 8 bits (0/255)
+inline cv::Mat unpackSlice(const BitSliceView& slice) {
+    cv::Mat image = cv::Mat::zeros(slice.rows, slice.cols, CV_8UC1);
+    for (int r = 0; r < slice.rows; r++) {
+        uchar* dst = image.ptr<uchar>(r);
+        forEachSetBit(slice.row(r), slice.wordsPerRow, [&](int c) { dst[c] = 255; });
+    }
+    return image;
+}
+
+// Ocupación de una imagen empaquetada: caja envolvente del objeto y un mapa de
+// teselas (TILE_ROWS filas x 64 columnas, una palabra) que contienen objeto.
+// Se calcula una vez tras la carga y permite saltar las zonas y las imágenes vacías.
+struct SliceOccupancy {
+    static const int TILE_ROWS = 32;
+
+    bool empty = true;
+    int minRow = 0, maxRow = -1;      // Caja envolvente en píxeles (inclusive)
+    int minCol = 0, maxCol = -1;
+    int tileRows = 0;
+    int tileCols = 0;                 // Una tesela por palabra de la fila
+    int bitmapWords = 0;              // Palabras del mapa por fila de teselas
+    std::vector<uint64_t> tiles;      // Bit t de la fila de teselas tr: tesela (tr, t) ocupada
+
+    void compute(const BitSliceView& slice) {
+        tileRows = (slice.rows + TILE_ROWS - 1) / TILE_ROWS;
+        tileCols = slice.wordsPerRow;
+        bitmapWords = packedWords(tileCols);
+        tiles.assign((size_t)tileRows * bitmapWords, 0);
+        empty = true;
+        minRow = minCol = INT_MAX;
+        maxRow = maxCol = -1;
+
+        for (int r = 0; r < slice.rows; r++) {
+            const uint64_t* row = slice.row(r);
+            uint64_t* tileBits = &tiles[(size_t)(r / TILE_ROWS) * bitmapWords];
+            for (int w = 0; w < slice.wordsPerRow; w++) {
+                if (!row[w]) continue;
+                tileBits[w >> 6] |= 1ULL << (w & 63);
+                minRow = std::min(minRow, r);
+                maxRow = r;
+                minCol = std::min(minCol, w * 64 + countTrailingZeros(row[w]));
+                maxCol = std::max(maxCol, w * 64 + highestSetBit(row[w]));
+                empty = false;
+            }
+        }
+        if (empty) {
+            minRow = minCol = 0;
+        }
+    }
+
+    const uint64_t* tileRow(int tr) const {
+        return &tiles[(size_t)tr * bitmapWords];
+    }
+
+    int occupiedTiles() const {
+        int count = 0;
+        for (uint64_t bits : tiles) count += popCount(bits);
+        return count;
+    }
+};
+
+// Recorrer los píxeles de borde de una imagen empaquetada en orden raster,
+// llamando emit(fila, bitsDeBordeDeLaFila). 'outside' es el valor asumido fuera
+// de la imagen (0 = método manual, ~0 = método morfológico, ver edgeRow).
+template <typename Emit>
+inline void forEachEdgeRow(const BitSliceView& slice, uint64_t outside, Emit emit) {
+    const int words = slice.wordsPerRow;
+    const uint64_t lastMask = lastWordMask(slice.cols);
+    std::vector<uint64_t> outsideRow(words, outside), edgeBits(words), scratch(words + 2);
+
+    for (int r = 0; r < slice.rows; r++) {
+        const uint64_t* above = (r > 0) ? slice.row(r - 1) : outsideRow.data();
+        const uint64_t* below = (r + 1 < slice.rows) ? slice.row(r + 1) : outsideRow.data();
+        edgeRow(above, slice.row(r), below, edgeBits.data(), scratch.data(), words, lastMask, outside);
+        emit(r, (const uint64_t*)edgeBits.data());
+    }
+}
+
+// Igual que forEachEdgeRow, pero visitando solo las filas de la caja envolvente y
+// dentro de ellas solo las palabras de teselas ocupadas (los bordes solo pueden
+// estar sobre píxeles de objeto). Una imagen vacía no cuesta nada.
+template <typename Emit>
+inline void forEachEdgeRowOccupied(const BitSliceView& slice, const SliceOccupancy& occupancy,
+                                   uint64_t outside, Emit emit) {
+    if (occupancy.empty) return;
+
+    const int words = slice.wordsPerRow;
+    const uint64_t lastMask = lastWordMask(slice.cols);
+    std::vector<uint64_t> outsideRow(words, outside), edgeBits(words), scratch(words + 2);
+
+    for (int r = occupancy.minRow; r <= occupancy.maxRow; r++) {
+        const uint64_t* above = (r > 0) ? slice.row(r - 1) : outsideRow.data();
+        const uint64_t* below = (r + 1 < slice.rows) ? slice.row(r + 1) : outsideRow.data();
+        const uint64_t* tileBits = occupancy.tileRow(r / SliceOccupancy::TILE_ROWS);
+        std::fill(edgeBits.begin(), edgeBits.end(), 0);
+
+        // Recorrer los tramos contiguos de teselas ocupadas de esta fila de teselas
+        for (int b = 0; b < occupancy.bitmapWords; b++) {
+            uint64_t bits = tileBits[b];
+            while (bits) {
+                int first = countTrailingZeros(bits);
+                uint64_t shifted = ~(bits >> first);
+                int length = shifted ? countTrailingZeros(shifted) : 64 - first;
+                int firstWord = b * 64 + first;
+                edgeRowSpan(above, slice.row(r), below, edgeBits.data(), scratch.data(), words, lastMask,
+                            outside, firstWord, firstWord + length);
+                bits = (first + length >= 64) ? 0 : bits & ~(((1ULL << length) - 1) << first);
+            }
+        }
+        emit(r, (const uint64_t*)edgeBits.data());
+    }
+}
+
+// Recorrer los vóxeles de superficie 3D de la imagen 'cur' en orden raster, llamando
+// emit(fila, bitsDeSuperficieDeLaFila) en las filas con objeto. 'prev' y 'next' son
+// las imágenes vecinas en z (nullptr = fuera del volumen, se asume 'outside').
+template <typename Emit>
+inline void forEachSurfaceRow(const BitSliceView* prev, const BitSliceView& cur, const BitSliceView* next,
+                              uint64_t outside, int connectivity, Emit emit) {
+    const int words = cur.wordsPerRow;
+    const uint64_t lastMask = lastWordMask(cur.cols);
+    std::vector<uint64_t> outsideRow(words, outside), surfaceBits(words), scratch(3 * (words + 2));
+    const BitSliceView* planes[3] = { prev, &cur, next };
+
+    for (int r = 0; r < cur.rows; r++) {
+        const uint64_t* center = cur.row(r);
+        bool hasObject = false;
+        for (int w = 0; w < words && !hasObject; w++) hasObject = center[w] != 0;
+        if (!hasObject) continue;
+
+        const uint64_t* rows[3][3];
+        for (int dz = 0; dz < 3; dz++) {
+            for (int dy = 0; dy < 3; dy++) {
+                int rr = r + dy - 1;
+                bool inside = planes[dz] && rr >= 0 && rr < cur.rows;
+                rows[dz][dy] = inside ? planes[dz]->row(rr) : outsideRow.data();
+            }
+        }
+        surfaceRow(rows, surfaceBits.data(), scratch.data(), words, lastMask, outside, connectivity);
+        emit(r, (const uint64_t*)surfaceBits.data());
+    }
+}
+
+#endif
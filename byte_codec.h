@@ -0,0 +1,47 @@
+#ifndef BYTE_CODEC_H
+#define BYTE_CODEC_H
+
+#include <vector>
+#include <cstdint>
+
+// Enteros de los formatos binarios (.edg, .oct, caché por imagen): little-endian
+// de ancho fijo y varints (7 bits por byte) con zigzag para los valores con signo.
+
+inline uint64_t zigzagEncode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+inline void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+// Leer un varint sin pasar de 'end'; false si está truncado o es demasiado largo
+inline bool readVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+inline void putLE(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) out.push_back((uint8_t)(value >> (8 * i)));
+}
+
+inline uint64_t loadLE(const uint8_t* src, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) value |= (uint64_t)src[i] << (8 * i);
+    return value;
+}
+
+#endif
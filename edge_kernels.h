@@ -0,0 +1,299 @@
+#ifndef EDGE_KERNELS_H
+#define EDGE_KERNELS_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Kernels de borde sobre filas binarias empaquetadas: 64 píxeles por palabra,
+// el bit j de la palabra w corresponde a la columna 64*w + j. Los bits que
+// sobran en la última palabra de cada fila deben valer 0.
+
+inline int packedWords(int cols) {
+    return (cols + 63) / 64;
+}
+
+// Máscara de los bits válidos de la última palabra de una fila
+inline uint64_t lastWordMask(int cols) {
+    int used = cols - (packedWords(cols) - 1) * 64;
+    return (used == 64) ? ~0ULL : ((1ULL << used) - 1);
+}
+
+inline int countTrailingZeros(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int n = 0;
+    while (!(word & 1)) { word >>= 1; n++; }
+    return n;
+#endif
+}
+
+// Posición del bit activo más alto (word != 0)
+inline int highestSetBit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(word);
+#else
+    int n = 0;
+    while (word >>= 1) n++;
+    return n;
+#endif
+}
+
+inline int popCount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int n = 0;
+    for (; word; word &= word - 1) n++;
+    return n;
+#endif
+}
+
+// Empaquetar una fila de 8 bits: un píxel es objeto si su valor es mayor que
+// 'threshold' (con 0, cualquier valor distinto de 0 es objeto)
+inline void packRow(const uchar* src, int cols, uint64_t* dst, uchar threshold = 0) {
+    const int words = packedWords(cols);
+    for (int w = 0; w < words; w++) {
+        const int base = w * 64;
+        const int count = std::min(64, cols - base);
+        uint64_t word = 0;
+        int j = 0;
+#if defined(__SSE2__)
+        // Comparación sin signo mediante el cambio del bit de signo
+        const __m128i bias = _mm_set1_epi8((char)0x80);
+        const __m128i limit = _mm_set1_epi8((char)(threshold ^ 0x80));
+        for (; j + 16 <= count; j += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + base + j));
+            __m128i above = _mm_cmpgt_epi8(_mm_xor_si128(bytes, bias), limit);
+            word |= (uint64_t)(uint32_t)_mm_movemask_epi8(above) << j;
+        }
+#endif
+        for (; j < count; j++) {
+            word |= (uint64_t)(src[base + j] > threshold) << j;
+        }
+        dst[w] = word;
+    }
+}
+
+// Calcular los píxeles de borde de las palabras [firstWord, lastWord) de una fila:
+//   borde = objeto AND NOT (AND de la vecindad 3x3)
+// 'above' y 'below' son las filas vecinas; 'outside' es el valor que se asume
+// fuera de la imagen: 0 reproduce isEdgePixel (el borde de la imagen cuenta
+// como fondo) y ~0 reproduce cv::erode (el borde de la imagen cuenta como objeto).
+// 'scratch' debe tener espacio para words + 2 palabras.
+inline void edgeRowSpan(const uint64_t* above, const uint64_t* cur, const uint64_t* below,
+                        uint64_t* out, uint64_t* scratch, int words, uint64_t lastMask, uint64_t outside,
+                        int firstWord, int lastWord) {
+    // AND vertical de las tres filas (más una palabra a cada lado del tramo),
+    // con una palabra de guarda a cada lado de la fila
+    uint64_t* v = scratch + 1;
+    scratch[0] = outside;
+    scratch[words + 1] = outside;
+    const int lo = std::max(firstWord - 1, 0);
+    const int hi = std::min(lastWord + 1, words);
+    for (int w = lo; w < hi; w++) {
+        v[w] = above[w] & cur[w] & below[w];
+    }
+    if (hi == words) {
+        v[words - 1] |= outside & ~lastMask;
+    }
+
+    // AND horizontal con los vecinos izquierdo y derecho
+    int w = firstWord;
+#if defined(__AVX2__)
+    for (; w + 4 <= lastWord; w += 4) {
+        __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + w - 1));
+        __m256i mid = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + w));
+        __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + w + 1));
+        __m256i fromLeft = _mm256_or_si256(_mm256_slli_epi64(mid, 1), _mm256_srli_epi64(left, 63));
+        __m256i fromRight = _mm256_or_si256(_mm256_srli_epi64(mid, 1), _mm256_slli_epi64(right, 63));
+        __m256i interior = _mm256_and_si256(mid, _mm256_and_si256(fromLeft, fromRight));
+        __m256i center = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + w));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w), _mm256_andnot_si256(interior, center));
+    }
+#elif defined(__ARM_NEON)
+    for (; w + 2 <= lastWord; w += 2) {
+        uint64x2_t left = vld1q_u64(v + w - 1);
+        uint64x2_t mid = vld1q_u64(v + w);
+        uint64x2_t right = vld1q_u64(v + w + 1);
+        uint64x2_t fromLeft = vorrq_u64(vshlq_n_u64(mid, 1), vshrq_n_u64(left, 63));
+        uint64x2_t fromRight = vorrq_u64(vshrq_n_u64(mid, 1), vshlq_n_u64(right, 63));
+        uint64x2_t interior = vandq_u64(mid, vandq_u64(fromLeft, fromRight));
+        vst1q_u64(out + w, vbicq_u64(vld1q_u64(cur + w), interior));
+    }
+#endif
+    for (; w < lastWord; w++) {
+        uint64_t mid = v[w];
+        uint64_t interior = mid & ((mid << 1) | (v[w - 1] >> 63)) & ((mid >> 1) | (v[w + 1] << 63));
+        out[w] = cur[w] & ~interior;
+    }
+}
+
+// Calcular los píxeles de borde de una fila completa (ver edgeRowSpan)
+inline void edgeRow(const uint64_t* above, const uint64_t* cur, const uint64_t* below,
+                    uint64_t* out, uint64_t* scratch, int words, uint64_t lastMask, uint64_t outside) {
+    edgeRowSpan(above, cur, below, out, scratch, words, lastMask, outside, 0, words);
+}
+
+// Copiar a 'dst' el AND de 'count' filas, con una palabra de guarda a cada lado
+// y los bits de relleno de la última palabra, todos con el valor 'outside'.
+// 'dst' apunta a la primera palabra de la fila (dst[-1] y dst[words] existen).
+inline void guardedAndRow(const uint64_t* const* rows, int count, uint64_t* dst, int words,
+                          uint64_t lastMask, uint64_t outside) {
+    for (int w = 0; w < words; w++) {
+        uint64_t value = rows[0][w];
+        for (int k = 1; k < count; k++) value &= rows[k][w];
+        dst[w] = value;
+    }
+    dst[-1] = outside;
+    dst[words] = outside;
+    dst[words - 1] |= outside & ~lastMask;
+}
+
+// AND de una palabra de fila con guardas con sus vecinos izquierdo y derecho
+inline uint64_t horizontalAnd(const uint64_t* v, int w) {
+    return v[w] & ((v[w] << 1) | (v[w - 1] >> 63)) & ((v[w] >> 1) | (v[w + 1] << 63));
+}
+
+// Calcular los vóxeles de superficie de una fila: vóxeles de objeto con algún
+// vecino de fondo según la conectividad 3D (6: caras, 18: caras y aristas,
+// 26: toda la vecindad 3x3x3). rows[dz][dy] es la fila (r + dy - 1) de la imagen
+// (z + dz - 1); las filas fuera del volumen deben valer 'outside'.
+// 'scratch' debe tener espacio para 3 * (words + 2) palabras.
+inline void surfaceRow(const uint64_t* const rows[3][3], uint64_t* out, uint64_t* scratch,
+                       int words, uint64_t lastMask, uint64_t outside, int connectivity) {
+    uint64_t* plane = scratch + 1;
+    uint64_t* before = plane + words + 2;
+    uint64_t* after = before + words + 2;
+    const uint64_t* cur = rows[1][1];
+
+    if (connectivity == 26) {
+        const uint64_t* all[9] = { rows[0][0], rows[0][1], rows[0][2], rows[1][0], rows[1][1],
+                                   rows[1][2], rows[2][0], rows[2][1], rows[2][2] };
+        guardedAndRow(all, 9, plane, words, lastMask, outside);
+        for (int w = 0; w < words; w++) {
+            out[w] = cur[w] & ~horizontalAnd(plane, w);
+        }
+    } else if (connectivity == 18) {
+        // Vecindad 3x3 en la imagen z y cruz de 5 vóxeles en las imágenes z-1 y z+1
+        guardedAndRow(rows[1], 3, plane, words, lastMask, outside);
+        guardedAndRow(&rows[0][1], 1, before, words, lastMask, outside);
+        guardedAndRow(&rows[2][1], 1, after, words, lastMask, outside);
+        for (int w = 0; w < words; w++) {
+            uint64_t interior = horizontalAnd(plane, w) &
+                                horizontalAnd(before, w) & rows[0][0][w] & rows[0][2][w] &
+                                horizontalAnd(after, w) & rows[2][0][w] & rows[2][2][w];
+            out[w] = cur[w] & ~interior;
+        }
+    } else {
+        // 6 vecinos: izquierda, derecha, arriba, abajo, imagen anterior y siguiente
+        guardedAndRow(&rows[1][1], 1, plane, words, lastMask, outside);
+        for (int w = 0; w < words; w++) {
+            uint64_t interior = horizontalAnd(plane, w) & rows[1][0][w] & rows[1][2][w] &
+                                rows[0][1][w] & rows[2][1][w];
+            out[w] = cur[w] & ~interior;
+        }
+    }
+}
+
+// Barrido fusionado de una imagen de 8 bits: umbral, empaquetado, borde y emisión
+// en una sola pasada por la imagen. Solo se guardan tres filas empaquetadas en un
+// búfer rotatorio; los búferes se reutilizan entre imágenes (sin reservas por imagen
+// mientras el ancho no crezca).
+class FusedEdgeSweep {
+private:
+    std::vector<uint64_t> rowRing;     // Filas r-1, r y r+1 empaquetadas (3 * words)
+    std::vector<uint64_t> outsideRow;
+    std::vector<uint64_t> edgeBits;
+    std::vector<uint64_t> scratch;
+
+    uint64_t* ringRow(int r, int words) {
+        return &rowRing[(size_t)(r % 3) * words];
+    }
+
+public:
+    // Llamar emit(fila, bitsDeBordeDeLaFila) para cada fila de 'image' (CV_8UC1).
+    // Un píxel es objeto si su valor es mayor que 'threshold'; 'outside' como en edgeRow.
+    template <typename Emit>
+    void run(const cv::Mat& image, uchar threshold, uint64_t outside, Emit emit) {
+        const int rows = image.rows;
+        const int words = packedWords(image.cols);
+        const uint64_t lastMask = lastWordMask(image.cols);
+        if (rows == 0 || words == 0) return;
+
+        rowRing.resize((size_t)3 * words);
+        outsideRow.assign(words, outside);
+        edgeBits.resize(words);
+        scratch.resize(words + 2);
+
+        packRow(image.ptr<uchar>(0), image.cols, ringRow(0, words), threshold);
+        for (int r = 0; r < rows; r++) {
+            // Empaquetar la fila de abajo justo antes de usarla
+            if (r + 1 < rows) {
+                packRow(image.ptr<uchar>(r + 1), image.cols, ringRow(r + 1, words), threshold);
+            }
+            const uint64_t* above = (r > 0) ? ringRow(r - 1, words) : outsideRow.data();
+            const uint64_t* below = (r + 1 < rows) ? ringRow(r + 1, words) : outsideRow.data();
+            edgeRow(above, ringRow(r, words), below, edgeBits.data(), scratch.data(), words, lastMask, outside);
+            emit(r, (const uint64_t*)edgeBits.data());
+        }
+    }
+};
+
+// Bordes entre etiquetas de una fila de una imagen etiquetada (8 o 16 bits): el
+// bit c se activa si la etiqueta de la columna c no es 0 (fondo) y alguno de sus
+// 8 vecinos tiene otra etiqueta. 'above' y 'below' nulos son filas fuera de la
+// imagen; fuera de la imagen se asume otra etiqueta ('outsideSame' = false, como
+// isEdgePixel) o la misma (true, como cv::erode). Con una sola etiqueta el
+// resultado coincide con edgeRow.
+template <typename T>
+inline void labelEdgeRow(const T* above, const T* cur, const T* below, int cols, bool outsideSame, uint64_t* out) {
+    const T* rows[3] = { above, cur, below };
+    const int words = packedWords(cols);
+    for (int w = 0; w < words; w++) {
+        const int base = w * 64;
+        const int count = std::min(64, cols - base);
+        uint64_t word = 0;
+        for (int j = 0; j < count; j++) {
+            const int c = base + j;
+            const T label = cur[c];
+            if (!label) continue;
+
+            bool differs = false;
+            for (const T* row : rows) {
+                if (!row) {
+                    differs = differs || !outsideSame;
+                    continue;
+                }
+                differs = differs || (c > 0 ? row[c - 1] != label : !outsideSame);
+                differs = differs || row[c] != label;
+                differs = differs || (c + 1 < cols ? row[c + 1] != label : !outsideSame);
+            }
+            word |= (uint64_t)differs << j;
+        }
+        out[w] = word;
+    }
+}
+
+// Llamar emit(col) para cada bit activo de una fila empaquetada, en orden de columna
+template <typename Emit>
+inline void forEachSetBit(const uint64_t* row, int words, Emit emit) {
+    for (int w = 0; w < words; w++) {
+        for (uint64_t bits = row[w]; bits; bits &= bits - 1) {
+            emit(w * 64 + countTrailingZeros(bits));
+        }
+    }
+}
+
+#endif
@@ -2,70 +2,717 @@
 #include <vector>
 #include <fstream>
 #include <string>
+#include <climits>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <cerrno>
+#include <cctype>
+#include <dirent.h>
 #include <opencv2/opencv.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
+#include "tiff_reader.h"
+#include "edge_kernels.h"
+#include "bit_volume.h"
+#include "rle_slice.h"
+#include "marching_cubes.h"
+#include "ascii_writer.h"
+#include "async_writer.h"
+#include "point_cloud_io.h"
+#include "point_stream.h"
+#include "octree_codec.h"
+#include "slice_cache.h"
+#include "slice_contours.h"
+#include "point_sampling.h"
+#include "run_metrics.h"
+#include "parallel_for.h"
+#include "memory_budget.h"
 
-struct Point3D {
-    double x, y, z;
-    Point3D(double x = 0, double y = 0, double z = 0) : x(x), y(y), z(z) {}
+// Punto de borde sobre la rejilla de vóxeles: columna (x), fila invertida (y) e
+// imagen (z), 16 bits cada una. Ocupa 6 bytes en lugar de los 24 de tres double;
+// las coordenadas como texto o float solo se generan al escribir los archivos.
+struct LatticePoint {
+    static const int LATTICE_LIMIT = 0xFFFF;
+    
+    uint16_t x, y, z;
+    LatticePoint(int x = 0, int y = 0, int z = 0) : x((uint16_t)x), y((uint16_t)y), z((uint16_t)z) {}
+    
+    // Clave de 64 bits que ordena en orden raster: z, y descendente, x
+    uint64_t rasterKey() const {
+        return (uint64_t)z << 32 | (uint64_t)(LATTICE_LIMIT - y) << 16 | x;
+    }
+};
+
+// Estadísticas de la nube acumuladas a medida que se extraen los puntos, para no
+// tener que guardar la nube completa cuando los puntos se escriben directamente
+struct PointStats {
+    size_t count = 0;
+    int minX = 0, maxX = 0, minY = 0, maxY = 0, minZ = 0, maxZ = 0;
+    
+    void add(const LatticePoint* begin, const LatticePoint* end) {
+        for (const LatticePoint* point = begin; point != end; point++) {
+            if (count == 0) {
+                minX = maxX = point->x;
+                minY = maxY = point->y;
+                minZ = maxZ = point->z;
+            }
+            minX = std::min<int>(minX, point->x);
+            maxX = std::max<int>(maxX, point->x);
+            minY = std::min<int>(minY, point->y);
+            maxY = std::max<int>(maxY, point->y);
+            minZ = std::min<int>(minZ, point->z);
+            maxZ = std::max<int>(maxZ, point->z);
+            count++;
+        }
+    }
+    
+    void add(const std::vector<LatticePoint>& points) {
+        add(points.data(), points.data() + points.size());
+    }
+    
+    // Acumular las estadísticas de otro grupo de puntos (p. ej. de otra imagen)
+    void merge(const PointStats& other) {
+        if (other.count == 0) return;
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        minX = std::min(minX, other.minX);
+        maxX = std::max(maxX, other.maxX);
+        minY = std::min(minY, other.minY);
+        maxY = std::max(maxY, other.maxY);
+        minZ = std::min(minZ, other.minZ);
+        maxZ = std::max(maxZ, other.maxZ);
+        count += other.count;
+    }
+};
+
+// Destino de los puntos de una imagen dentro de la nube ya dimensionada: se usa
+// como un vector (push_back) pero escribe en posiciones consecutivas reservadas
+// de antemano, sin comprobar capacidad ni reubicar
+struct PointSpan {
+    LatticePoint* next;
+    
+    explicit PointSpan(LatticePoint* first) : next(first) {}
+    void push_back(const LatticePoint& point) { *next++ = point; }
 };
 
 class MultiTiffEdgeExtractor {
 private:
-    std::vector<cv::Mat> images;
-    std::vector<Point3D> pointCloud;
-    int totalImages;
-    
-    // Función para detectar si un píxel es borde
-    bool isEdgePixel(const cv::Mat& img, int row, int col) {
-        // Verificar si el píxel actual es blanco
-        if (img.at<uchar>(row, col) == 0) return false;
-        
-        // Verificar los 8 vecinos
-        for (int dr = -1; dr <= 1; dr++) {
-            for (int dc = -1; dc <= 1; dc++) {
-                if (dr == 0 && dc == 0) continue;
-                
-                int newRow = row + dr;
-                int newCol = col + dc;
-                
-                // Verificar límites
-                if (newRow < 0 || newRow >= img.rows || 
-                    newCol < 0 || newCol >= img.cols) {
-                    return true; // Borde de la imagen
+    BitVolume volume;              // Imágenes binarias cargadas, 1 bit por píxel
+    std::vector<SliceOccupancy> occupancy; // Caja envolvente y teselas ocupadas de cada imagen
+    std::vector<RleSlice> runSlices; // Mismas imágenes codificadas por tramos (--kernel rle)
+    bool useRunLength = false;     // Extraer bordes sobre tramos en lugar de palabras de bits
+    std::vector<LatticePoint> pointCloud;
+    std::vector<uint16_t> pointLabels; // Etiqueta de cada punto (solo en modo multi-etiqueta)
+    PointStats stats;              // Estadísticas de todos los puntos extraídos
+    std::ostream* pointSink = nullptr; // Si existe, los puntos se escriben aquí en vez de guardarse
+    bool compactOutput = false;    // Escribir los puntos en formato compacto (.edg) en lugar de XYZ
+    CompactPointWriter compactWriter;
+    int totalImages = 0;
+    int firstImageIndex = 0;       // Índice de la primera página cargada en 'volume'
+    bool persistPageIndex = false; // Guardar/reutilizar el índice de páginas junto al TIFF
+    int numThreads = 1;            // Hilos para la extracción por imagen
+    int surfaceConnectivity = 0;   // 6/18/26: superficie 3D; 0: bordes 2D por imagen
+    std::mutex progressMutex;
+    bool verbose = true;           // Mensajes de progreso de carga y extracción
+    SliceCache sliceCache;         // Puntos de imágenes ya procesadas (--cache), si está activa
+    std::atomic<int> cacheHits{0};    // Imágenes leídas de la caché en la última extracción
+    std::atomic<int> cacheMisses{0};  // Imágenes con objeto extraídas y añadidas a la caché
+    std::atomic<bool> cacheWarned{false};
+    RunMetrics* metrics = nullptr;  // Tiempos y contadores por fase (--metrics), si se piden
+    
+    // Sumar a las métricas la última página decodificada por 'reader'
+    void countDecodedPage(const TiffPageReader& reader) {
+        if (metrics) {
+            metrics->addCounter("pages_decoded", 1);
+            metrics->addCounter("bytes_read", reader.lastPageInfo().storedBytes());
+            metrics->addCounter("bytes_decoded", reader.lastPageInfo().decodedBytes());
+        }
+    }
+    
+    // Las páginas en modo streaming se recorren completas
+    void countScannedPage(const cv::Mat& page) {
+        if (metrics) metrics->addCounter("pixels_scanned", (long long)page.rows * page.cols);
+    }
+    
+    // Leer la siguiente página midiendo la decodificación
+    bool readNextPageTimed(TiffPageReader& reader, cv::Mat& page, int flags = cv::IMREAD_GRAYSCALE) {
+        PhaseTimer timer(metrics, "decode");
+        if (!reader.readNextPage(page, flags)) return false;
+        countDecodedPage(reader);
+        return true;
+    }
+    
+    // Extraer los puntos de borde de una página de 8 bits leída en modo streaming
+    // (objeto: valor > 127). Umbral, empaquetado, borde y emisión se hacen en una
+    // sola pasada con los búferes de 'sweep', que se reutilizan entre páginas. El
+    // método manual trata el borde de la imagen como fondo (isEdgePixel) y el
+    // morfológico como objeto (cv::erode seguido de la resta).
+    void extractSliceEdges(const cv::Mat& page, int imgIndex, bool useMorphological,
+                           std::vector<LatticePoint>& points, FusedEdgeSweep& sweep) {
+        const uint64_t outside = useMorphological ? ~0ULL : 0;
+        const int words = packedWords(page.cols);
+        
+        sweep.run(page, 127, outside, [&](int row, const uint64_t* edgeBits) {
+            forEachSetBit(edgeBits, words, [&](int col) {
+                // Invertir Y para coordenadas estándar; z = número de imagen (0-based)
+                points.push_back(LatticePoint(col, page.rows - row, imgIndex));
+            });
+        });
+    }
+    
+    // Extraer los puntos de borde de una imagen empaquetada del volumen. El método
+    // morfológico usa la misma regla que cv::erode: fuera de la imagen se asume objeto.
+    // Solo se visitan las teselas de la imagen que contienen objeto. 'Points' es un
+    // std::vector<LatticePoint> o un PointSpan sobre la nube (ver extractImagesInPlace).
+    template <typename Points>
+    void extractSliceEdges(const BitSliceView& slice, const SliceOccupancy& sliceOccupancy, int imgIndex,
+                           bool useMorphological, Points& points) {
+        const uint64_t outside = useMorphological ? ~0ULL : 0;
+        
+        forEachEdgeRowOccupied(slice, sliceOccupancy, outside, [&](int row, const uint64_t* edgeBits) {
+            forEachSetBit(edgeBits, slice.wordsPerRow, [&](int col) {
+                // Invertir Y para coordenadas estándar; z = número de imagen (0-based)
+                points.push_back(LatticePoint(col, slice.rows - row, imgIndex));
+            });
+        });
+    }
+    
+    // Extraer los vóxeles de superficie 3D de una imagen empaquetada, mirando también
+    // las imágenes vecinas en z ('prev'/'next' nulos fuera del volumen). El método
+    // morfológico asume objeto fuera del volumen y el manual, fondo.
+    template <typename Points>
+    void extractSliceSurface(const BitSliceView* prev, const BitSliceView& slice, const BitSliceView* next,
+                             int imgIndex, bool useMorphological, Points& points) {
+        const uint64_t outside = useMorphological ? ~0ULL : 0;
+        
+        forEachSurfaceRow(prev, slice, next, outside, surfaceConnectivity, [&](int row, const uint64_t* surfaceBits) {
+            forEachSetBit(surfaceBits, slice.wordsPerRow, [&](int col) {
+                // Invertir Y para coordenadas estándar; z = número de imagen (0-based)
+                points.push_back(LatticePoint(col, slice.rows - row, imgIndex));
+            });
+        });
+    }
+    
+    // Extraer los puntos de borde de una imagen codificada por tramos; el costo
+    // depende del número de tramos y de píxeles de borde, no del área
+    template <typename Points>
+    void extractSliceEdges(const RleSlice& slice, int imgIndex, bool useMorphological, Points& points) {
+        forEachEdgeRun(slice, useMorphological, [&](int row, int start, int end) {
+            for (int col = start; col < end; col++) {
+                points.push_back(LatticePoint(col, slice.rows() - row, imgIndex));
+            }
+        });
+    }
+    
+    // Los puntos guardan coordenadas de 16 bits: comprobar que caben las imágenes
+    // de rows x cols (x < cols, y <= rows) y el índice de imagen 'lastImage'
+    static bool fitsLattice(int rows, int cols, int lastImage) {
+        if (rows > LatticePoint::LATTICE_LIMIT || cols > LatticePoint::LATTICE_LIMIT ||
+            lastImage > LatticePoint::LATTICE_LIMIT) {
+            std::cerr << "Error: La pila supera el límite de " << LatticePoint::LATTICE_LIMIT
+                      << " píxeles o imágenes por eje" << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    // Índices auxiliares calculados una sola vez tras la carga: ocupación por
+    // teselas de cada imagen y, con --kernel rle, su codificación por tramos
+    void finishLoad() {
+        PhaseTimer timer(metrics, "index");
+        occupancy.assign(volume.slices(), SliceOccupancy());
+        runSlices.clear();
+        if (useRunLength) {
+            runSlices.resize(volume.slices());
+        }
+        
+        parallelFor(volume.slices(), numThreads, [&](int z, int) {
+            occupancy[z].compute(volume.slice(z));
+            if (useRunLength) {
+                runSlices[z].build(volume.slice(z), &occupancy[z]);
+            }
+        });
+    }
+    
+    // Escribir puntos en texto plano "x y z", formato común a XYZ, PLY y PCD ASCII
+    static void writePoints(std::ostream& out, const std::vector<LatticePoint>& points) {
+        AsciiWriter writer(out, std::min<size_t>(1 << 20, points.size() * 24 + 64));
+        for (const auto& point : points) {
+            writer.integer(point.x);
+            writer.put(' ');
+            writer.integer(point.y);
+            writer.put(' ');
+            writer.integer(point.z);
+            writer.put('\n');
+        }
+    }
+
+    // Escribir puntos etiquetados en formato XYZ con una cuarta columna (etiqueta)
+    static void writeLabelledPoints(std::ostream& out, const std::vector<LatticePoint>& points,
+                                    const std::vector<uint16_t>& labels) {
+        AsciiWriter writer(out, std::min<size_t>(1 << 20, points.size() * 32 + 64));
+        for (size_t i = 0; i < points.size(); i++) {
+            writer.integer(points[i].x);
+            writer.put(' ');
+            writer.integer(points[i].y);
+            writer.put(' ');
+            writer.integer(points[i].z);
+            writer.put(' ');
+            writer.integer(labels[i]);
+            writer.put('\n');
+        }
+    }
+    
+    // Extraer los bordes de todas las etiquetas de una página etiquetada (T = uchar
+    // o uint16_t) en una sola pasada; 'edgeBits' se reutiliza entre páginas
+    template <typename T>
+    void extractLabelSlice(const cv::Mat& page, int imgIndex, bool useMorphological, std::vector<LatticePoint>& points,
+                           std::vector<uint16_t>& labels, std::vector<uint64_t>& edgeBits) {
+        const int words = packedWords(page.cols);
+        edgeBits.resize(words);
+        
+        for (int row = 0; row < page.rows; row++) {
+            const T* cur = page.ptr<T>(row);
+            const T* above = (row > 0) ? page.ptr<T>(row - 1) : nullptr;
+            const T* below = (row + 1 < page.rows) ? page.ptr<T>(row + 1) : nullptr;
+            labelEdgeRow(above, cur, below, page.cols, useMorphological, edgeBits.data());
+            
+            forEachSetBit(edgeBits.data(), words, [&](int col) {
+                // Invertir Y para coordenadas estándar; z = número de imagen (0-based)
+                points.push_back(LatticePoint(col, page.rows - row, imgIndex));
+                labels.push_back((uint16_t)cur[col]);
+            });
+        }
+    }
+    
+    // Extraer los puntos de una imagen cargada (índice absoluto de página)
+    template <typename Points>
+    void extractImage(int imgIndex, bool useMorphological, Points& points) {
+        // Las imágenes vacías se saltan sin recorrerlas
+        int z = imgIndex - firstImageIndex;
+        if (occupancy[z].empty) return;
+        if (metrics) metrics->addCounter("pixels_scanned", scannedPixels(z));
+        
+        if (surfaceConnectivity > 0) {
+            // Las vecinas en z son las imágenes cargadas contiguas
+            BitSliceView prev, next;
+            if (z > 0) prev = volume.slice(z - 1);
+            if (z + 1 < volume.slices()) next = volume.slice(z + 1);
+            extractSliceSurface(z > 0 ? &prev : nullptr, volume.slice(z),
+                                z + 1 < volume.slices() ? &next : nullptr, imgIndex, useMorphological, points);
+        } else if (useRunLength) {
+            extractSliceEdges(runSlices[z], imgIndex, useMorphological, points);
+        } else {
+            extractSliceEdges(volume.slice(z), occupancy[z], imgIndex, useMorphological, points);
+        }
+    }
+    
+    // Píxeles que recorre el kernel en la imagen z del volumen: las teselas ocupadas
+    // con el kernel de bits y la imagen completa con la superficie 3D o los tramos
+    long long scannedPixels(int z) const {
+        if (surfaceConnectivity > 0 || useRunLength) return (long long)volume.rows() * volume.cols();
+        return (long long)occupancy[z].occupiedTiles() * SliceOccupancy::TILE_ROWS * 64;
+    }
+    
+    // Contar los puntos que extractImage daría para una imagen sin generarlos: se
+    // recorren las mismas filas de borde sumando sus bits (popcount) o, con tramos,
+    // la longitud de los tramos de borde
+    size_t countImagePoints(int imgIndex, bool useMorphological) {
+        int z = imgIndex - firstImageIndex;
+        if (occupancy[z].empty) return 0;
+        
+        const uint64_t outside = useMorphological ? ~0ULL : 0;
+        const int words = volume.slice(z).wordsPerRow;
+        size_t count = 0;
+        auto countRow = [&](int, const uint64_t* bits) {
+            for (int w = 0; w < words; w++) count += popCount(bits[w]);
+        };
+        
+        if (surfaceConnectivity > 0) {
+            BitSliceView prev, next;
+            if (z > 0) prev = volume.slice(z - 1);
+            if (z + 1 < volume.slices()) next = volume.slice(z + 1);
+            forEachSurfaceRow(z > 0 ? &prev : nullptr, volume.slice(z), z + 1 < volume.slices() ? &next : nullptr,
+                              outside, surfaceConnectivity, countRow);
+        } else if (useRunLength) {
+            forEachEdgeRun(runSlices[z], useMorphological, [&](int, int start, int end) { count += end - start; });
+        } else {
+            forEachEdgeRowOccupied(volume.slice(z), occupancy[z], outside, countRow);
+        }
+        return count;
+    }
+    
+    // Entregar los puntos de una imagen: se escriben en 'out' si se indica (sin
+    // guardarlos) o se añaden a la nube; las estadísticas se actualizan siempre
+    void emitPoints(const std::vector<LatticePoint>& points, std::ostream* out) {
+        PhaseTimer timer(out ? metrics : nullptr, "emit");
+        stats.add(points);
+        if (out && compactOutput) {
+            compactWriter.writeSlice(*out, points);
+        } else if (out) {
+            writePoints(*out, points);
+        } else {
+            pointCloud.insert(pointCloud.end(), points.begin(), points.end());
+        }
+    }
+    
+    void clearPoints() {
+        pointCloud.clear();
+        pointLabels.clear();
+        stats = PointStats();
+    }
+    
+    // Claves de caché de las imágenes cargadas [startImg, endImg]: contenido de la
+    // imagen y parámetros de extracción y, con superficie 3D, también las vecinas
+    std::vector<SliceKey> imageCacheKeys(int startImg, int endImg, bool useMorphological) {
+        int first = std::max(startImg - 1, firstImageIndex) - firstImageIndex;
+        int last = std::min(endImg + 1, firstImageIndex + volume.slices() - 1) - firstImageIndex;
+        std::vector<SliceKey> sliceHashes(last - first + 1);
+        parallelFor(sliceHashes.size(), numThreads, [&](int i, int) {
+            sliceHashes[i] = hashSlice(volume.slice(first + i), occupancy[first + i]);
+        });
+        
+        std::vector<SliceKey> keys(endImg - startImg + 1);
+        for (int imgIndex = startImg; imgIndex <= endImg; imgIndex++) {
+            int z = imgIndex - firstImageIndex;
+            SliceKey& key = keys[imgIndex - startImg];
+            key.add(SLICE_CACHE_VERSION);
+            key.add(useMorphological);
+            key.add(surfaceConnectivity);
+            key.add(volume.rows());
+            key.add(volume.cols());
+            key.add(sliceHashes[z - first]);
+            if (surfaceConnectivity > 0) {
+                key.add(z > 0);
+                if (z > 0) key.add(sliceHashes[z - 1 - first]);
+                key.add(z + 1 < volume.slices());
+                if (z + 1 < volume.slices()) key.add(sliceHashes[z + 1 - first]);
+            }
+        }
+        return keys;
+    }
+    
+    // Buscar en la caché los puntos de una imagen con objeto (las vacías no se guardan)
+    bool loadCachedImage(int imgIndex, const SliceKey& key, std::vector<LatticePoint>& points) {
+        if (occupancy[imgIndex - firstImageIndex].empty || !sliceCache.load(key, imgIndex, points)) {
+            return false;
+        }
+        cacheHits++;
+        return true;
+    }
+    
+    // Guardar en la caché los puntos recién extraídos de una imagen; si falla se
+    // avisa una vez y la extracción sigue
+    void storeCachedImage(int imgIndex, const SliceKey& key, const LatticePoint* begin, const LatticePoint* end) {
+        if (occupancy[imgIndex - firstImageIndex].empty) return;
+        cacheMisses++;
+        if (!sliceCache.store(key, begin, end, imgIndex) && !cacheWarned.exchange(true)) {
+            std::cerr << "Aviso: No se pudieron guardar imágenes en la caché" << std::endl;
+        }
+    }
+    
+    // Convertir los conteos por imagen de offsets[1..n] en posiciones dentro de la
+    // nube y dimensionarla una sola vez: la imagen i ocupa [offsets[i], offsets[i+1])
+    void allocateImageRegions(std::vector<size_t>& offsets) {
+        offsets[0] = pointCloud.size();
+        for (size_t i = 1; i < offsets.size(); i++) offsets[i] += offsets[i - 1];
+        pointCloud.resize(offsets.back());
+    }
+    
+    // Escribir los puntos de una imagen directamente en su región de la nube
+    void fillImage(int imgIndex, bool useMorphological, size_t first) {
+        PointSpan span(pointCloud.data() + first);
+        extractImage(imgIndex, useMorphological, span);
+    }
+    
+    // Extracción en dos pasadas para la nube en memoria: primero se cuentan los
+    // puntos de cada imagen (countImagePoints), la suma acumulada da la región de
+    // cada imagen en la nube y en la segunda pasada cada hilo la llena sin vectores
+    // intermedios, sin reubicaciones y sin copiar al final. El orden de los puntos
+    // es el mismo que en la extracción secuencial. Con caché, las imágenes que ya
+    // están en ella se leen en la primera pasada y solo se copian en la segunda.
+    void extractImagesInPlace(int startImg, int endImg, bool useMorphological, int progressEvery,
+                              const std::vector<SliceKey>& keys) {
+        int count = endImg - startImg + 1;
+        std::vector<size_t> offsets(count + 1, 0);
+        std::vector<std::vector<LatticePoint>> cached(count);
+        std::vector<char> isCached(count, 0);
+        {
+            PhaseTimer timer(metrics, "extract_count");
+            parallelFor(count, numThreads, [&](int i, int) {
+                int imgIndex = startImg + i;
+                isCached[i] = sliceCache.enabled() && loadCachedImage(imgIndex, keys[i], cached[i]);
+                offsets[i + 1] = isCached[i] ? cached[i].size() : countImagePoints(imgIndex, useMorphological);
+            });
+            allocateImageRegions(offsets);
+        }
+        
+        PhaseTimer timer(metrics, "extract_fill");
+        std::vector<PointStats> imageStats(count);
+        parallelFor(count, numThreads, [&](int i, int) {
+            int imgIndex = startImg + i;
+            // Mostrar progreso
+            if (verbose && imgIndex % progressEvery == 0) {
+                std::lock_guard<std::mutex> lock(progressMutex);
+                std::cout << "Procesando imagen " << (imgIndex + 1) << "/" << totalImages << std::endl;
+            }
+            
+            LatticePoint* region = pointCloud.data() + offsets[i];
+            SliceTimer sliceTimer(metrics);
+            if (isCached[i]) {
+                std::copy(cached[i].begin(), cached[i].end(), region);
+                std::vector<LatticePoint>().swap(cached[i]);
+            } else {
+                fillImage(imgIndex, useMorphological, offsets[i]);
+                if (sliceCache.enabled()) {
+                    storeCachedImage(imgIndex, keys[i], region, pointCloud.data() + offsets[i + 1]);
                 }
-                
-                // Si hay un píxel negro adyacente, es borde
-                if (img.at<uchar>(newRow, newCol) == 0) {
-                    return true;
+            }
+            imageStats[i].add(pointCloud.data() + offsets[i], pointCloud.data() + offsets[i + 1]);
+        });
+        for (const auto& sliceStats : imageStats) stats.merge(sliceStats);
+    }
+    
+    // Extraer los bordes de las imágenes cargadas [startImg, endImg] en paralelo.
+    // Sin 'pointSink' la nube se llena en dos pasadas (extractImagesInPlace). Con
+    // 'pointSink' cada imagen llena su propio buffer y se escribe en cuanto están
+    // listas todas las anteriores, mientras los demás hilos siguen extrayendo, y
+    // luego se libera; el resultado es idéntico al de la versión secuencial.
+    void extractImages(int startImg, int endImg, bool useMorphological, int progressEvery) {
+        int count = endImg - startImg + 1;
+        if (count <= 0) return;
+        PhaseTimer timer(metrics, "extract");
+        
+        std::vector<SliceKey> keys;
+        if (sliceCache.enabled()) {
+            PhaseTimer keyTimer(metrics, "cache_keys");
+            keys = imageCacheKeys(startImg, endImg, useMorphological);
+            cacheHits = 0;
+            cacheMisses = 0;
+        }
+        
+        if (!pointSink) {
+            extractImagesInPlace(startImg, endImg, useMorphological, progressEvery, keys);
+        } else {
+            extractImagesToSink(startImg, endImg, useMorphological, progressEvery, keys);
+        }
+        
+        if (metrics) {
+            for (int z = startImg - firstImageIndex; z <= endImg - firstImageIndex; z++) {
+                if (occupancy[z].empty) metrics->addCounter("images_empty", 1);
+            }
+            metrics->addCounter("images_extracted", count);
+            if (sliceCache.enabled()) {
+                metrics->addCounter("cache_hits", cacheHits);
+                metrics->addCounter("cache_misses", cacheMisses);
+            }
+        }
+        if (sliceCache.enabled() && verbose) {
+            std::cout << "Caché: " << cacheHits << " imágenes reutilizadas, " << cacheMisses
+                      << " extraídas" << std::endl;
+        }
+    }
+    
+    // Extracción con 'pointSink' (ver extractImages)
+    void extractImagesToSink(int startImg, int endImg, bool useMorphological, int progressEvery,
+                             const std::vector<SliceKey>& keys) {
+        int count = endImg - startImg + 1;
+        std::vector<std::vector<LatticePoint>> slicePoints(count);
+        std::vector<char> finished(count, 0);
+        int nextToWrite = 0;
+        
+        parallelFor(count, numThreads, [&](int i, int) {
+            int imgIndex = startImg + i;
+            // Mostrar progreso
+            if (verbose && imgIndex % progressEvery == 0) {
+                std::lock_guard<std::mutex> lock(progressMutex);
+                std::cout << "Procesando imagen " << (imgIndex + 1) << "/" << totalImages << std::endl;
+            }
+            
+            if (!sliceCache.enabled() || !loadCachedImage(imgIndex, keys[i], slicePoints[i])) {
+                SliceTimer sliceTimer(metrics);
+                extractImage(imgIndex, useMorphological, slicePoints[i]);
+                if (sliceCache.enabled()) {
+                    storeCachedImage(imgIndex, keys[i], slicePoints[i].data(),
+                                     slicePoints[i].data() + slicePoints[i].size());
                 }
             }
+            
+            std::lock_guard<std::mutex> lock(progressMutex);
+            finished[i] = 1;
+            for (; nextToWrite < count && finished[nextToWrite]; nextToWrite++) {
+                emitPoints(slicePoints[nextToWrite], pointSink);
+                std::vector<LatticePoint>().swap(slicePoints[nextToWrite]);
+            }
+        });
+    }
+
+    // Decodificar las páginas [startImg, endImg] al volumen empaquetado, en paralelo
+    // y con un lector por hilo. Devuelve false sin mensaje si alguna página no es
+    // soportada por el lector o tiene otras dimensiones, para recurrir a OpenCV.
+    bool loadPagesPacked(TiffPageReader& reader, int startImg, int endImg) {
+        TiffPageInfo first, info;
+        if (!reader.pageInfo(startImg, first)) {
+            return false;
+        }
+        long long bytesRead = 0, bytesDecoded = 0;
+        for (int i = startImg; i <= endImg; i++) {
+            if (!reader.pageInfo(i, info) || !reader.canDecode(info) ||
+                info.width != first.width || info.height != first.height) {
+                return false;
+            }
+            bytesRead += info.storedBytes();
+            bytesDecoded += info.decodedBytes();
+        }
+        PhaseTimer timer(metrics, "decode");
+        
+        volume.create(endImg - startImg + 1, first.height, first.width);
+        
+        std::vector<TiffPageReader> readers(std::min(numThreads, volume.slices()));
+        for (auto& worker : readers) {
+            if (!worker.open(reader.path())) {
+                return false;
+            }
+            worker.copyIndexFrom(reader);
+        }
+        
+        std::atomic<bool> failed(false);
+        parallelFor(endImg - startImg + 1, numThreads, [&](int i, int worker) {
+            int imgIndex = startImg + i;
+            if (!failed && !readers[worker].readPageBits(imgIndex, volume.sliceData(imgIndex - startImg), volume.words())) {
+                failed = true;
+            }
+        });
+        
+        if (failed) {
+            volume.clear();
+            return false;
+        }
+        if (metrics) {
+            metrics->addCounter("pages_decoded", volume.slices());
+            metrics->addCounter("bytes_read", bytesRead);
+            metrics->addCounter("bytes_decoded", bytesDecoded);
         }
-        return false;
+        return true;
     }
     
-    // Función alternativa usando operadores morfológicos
-    cv::Mat detectEdgesMorphological(const cv::Mat& binary) {
-        cv::Mat edges;
-        cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+    // Carga de respaldo con cv::imreadmulti (formatos que el lector por páginas no soporta)
+    bool loadWithOpenCV(const std::string& filename) {
+        volume.clear();
+        firstImageIndex = 0;
         
-        // Erosión de la imagen binaria
-        cv::Mat eroded;
-        cv::erode(binary, eroded, kernel);
+        // Cargar todas las imágenes del TIFF (OpenCV no informa de los bytes leídos)
+        PhaseTimer timer(metrics, "decode");
+        std::vector<cv::Mat> tempImages;
+        bool success = cv::imreadmulti(filename, tempImages, cv::IMREAD_GRAYSCALE);
         
-        // Restar erosión de la imagen original para obtener bordes
-        cv::subtract(binary, eroded, edges);
+        if (!success || tempImages.empty()) {
+            std::cerr << "Error: No se pudo cargar el archivo multi-TIFF " << filename << std::endl;
+            return false;
+        }
+        
+        totalImages = tempImages.size();
+        if (metrics) metrics->addCounter("pages_decoded", totalImages);
+        volume.create(totalImages, tempImages[0].rows, tempImages[0].cols);
         
-        return edges;
+        // Umbralizar y empaquetar cada imagen (equivale a cv::threshold(127))
+        for (int i = 0; i < totalImages; i++) {
+            if (tempImages[i].rows != volume.rows() || tempImages[i].cols != volume.cols()) {
+                std::cerr << "Error: Las imágenes del TIFF no tienen todas las mismas dimensiones" << std::endl;
+                volume.clear();
+                return false;
+            }
+            volume.packSlice(i, tempImages[i], 127);
+            tempImages[i].release();
+        }
+        
+        return true;
     }
 
 public:
+    void setPersistPageIndex(bool persist) {
+        persistPageIndex = persist;
+    }
+    
+    // Usar la representación por tramos (RLE) para la extracción de bordes
+    void setRunLengthKernel(bool enable) {
+        useRunLength = enable;
+    }
+    
+    // Número de hilos para la extracción (0 = todos los núcleos disponibles)
+    void setNumThreads(int threads) {
+        if (threads <= 0) {
+            threads = (int)std::thread::hardware_concurrency();
+        }
+        numThreads = std::max(1, threads);
+    }
+    
+    int threadCount() const {
+        return numThreads;
+    }
+    
+    // Extraer la superficie 3D con conectividad 6, 18 o 26 en lugar de los bordes
+    // 2D de cada imagen (0 desactiva el modo 3D)
+    void setSurfaceConnectivity(int connectivity) {
+        surfaceConnectivity = connectivity;
+    }
+    
+    // Escribir los puntos en 'sink' a medida que se extraen, en orden, en lugar de
+    // acumularlos en la nube (nullptr vuelve a acumularlos)
+    void setPointSink(std::ostream* sink) {
+        pointSink = sink;
+    }
+    
+    // Escribir los puntos entregados a un flujo en formato compacto (.edg, ver
+    // point_stream.h); el archivo se cierra con finishPointOutput
+    void setCompactOutput(bool enable) {
+        compactOutput = enable;
+    }
+    
+    // Completar el archivo de puntos escrito en 'out' (índice del formato compacto)
+    bool finishPointOutput(std::ostream& out) {
+        return !compactOutput || compactWriter.finish(out);
+    }
+    
+    // Reutilizar los puntos de las imágenes que no cambiaron entre ejecuciones,
+    // guardándolos en el directorio 'directory'
+    bool setSliceCache(const std::string& directory) {
+        return sliceCache.open(directory);
+    }
+    
+    // Registrar tiempos por fase y contadores en 'runMetrics' (nullptr: no medir)
+    void setMetrics(RunMetrics* runMetrics) {
+        metrics = runMetrics;
+    }
+    
+    // Puntos extraídos (y submuestreados, si se pidió) hasta ahora
+    size_t pointCount() const {
+        return stats.count;
+    }
+    
+    // Mostrar u ocultar los mensajes de progreso (los errores siempre se muestran)
+    void setVerbose(bool enable) {
+        verbose = enable;
+    }
+    
     // Cargar archivo TIFF multi-imagen
     bool loadMultiTiffImage(const std::string& filename) {
-        images.clear();
+        volume.clear();
+        firstImageIndex = 0;
         
-        std::cout << "Cargando archivo TIFF multi-imagen: " << filename << std::endl;
+        if (verbose) {
+            std::cout << "Cargando archivo TIFF multi-imagen: " << filename << std::endl;
+        }
         
         // Verificar si el archivo existe
         std::ifstream file(filename);
@@ -75,144 +722,722 @@ public:
         }
         file.close();
         
-        // Cargar todas las imágenes del TIFF
-        std::vector<cv::Mat> tempImages;
-        bool success = cv::imreadmulti(filename, tempImages, cv::IMREAD_GRAYSCALE);
+        // Decodificar cada página directamente al volumen empaquetado; si el
+        // lector por páginas no soporta el formato se recurre a OpenCV
+        TiffPageReader reader;
+        if (reader.open(filename) && reader.openIndex(persistPageIndex) &&
+            loadPagesPacked(reader, 0, reader.pageCount() - 1)) {
+            totalImages = volume.slices();
+        } else if (!loadWithOpenCV(filename)) {
+            return false;
+        }
+        if (!fitsLattice(volume.rows(), volume.cols(), volume.slices() - 1)) {
+            volume.clear();
+            return false;
+        }
         
-        if (!success || tempImages.empty()) {
-            std::cerr << "Error: No se pudo cargar el archivo multi-TIFF " << filename << std::endl;
+        if (verbose) {
+            std::cout << "Número total de imágenes encontradas: " << totalImages << std::endl;
+            std::cout << "Dimensiones de imagen: " << volume.cols() << "x" << volume.rows() << " píxeles" << std::endl;
+        }
+        
+        finishLoad();
+        return true;
+    }
+    
+    // Cargar solo las páginas [startImg, endImg] usando el índice de IFDs,
+    // de modo que el costo depende del tamaño del rango y no de la pila
+    bool loadMultiTiffRange(const std::string& filename, int startImg, int endImg) {
+        volume.clear();
+        firstImageIndex = 0;
+        
+        std::cout << "Cargando rango de imágenes del TIFF: " << filename << std::endl;
+        
+        TiffPageReader reader;
+        if (!reader.open(filename) || !reader.openIndex(persistPageIndex)) {
             return false;
         }
         
-        totalImages = tempImages.size();
+        totalImages = reader.pageCount();
         std::cout << "Número total de imágenes encontradas: " << totalImages << std::endl;
         
-        // Procesar cada imagen para asegurar que sea binaria
-        for (int i = 0; i < totalImages; i++) {
-            cv::Mat binaryImage;
-            cv::threshold(tempImages[i], binaryImage, 127, 255, cv::THRESH_BINARY);
-            images.push_back(binaryImage);
-            
-            if (i == 0) {
-                std::cout << "Dimensiones de imagen: " << binaryImage.cols << "x" << binaryImage.rows << " píxeles" << std::endl;
+        startImg = std::max(0, startImg);
+        endImg = std::min(totalImages - 1, endImg);
+        if (startImg > endImg) {
+            std::cerr << "Error: Rango de imágenes vacío" << std::endl;
+            return false;
+        }
+        
+        if (!loadPagesPacked(reader, startImg, endImg)) {
+            // Formato no soportado por el lector por páginas: cargar la pila completa
+            if (!loadWithOpenCV(filename) || !fitsLattice(volume.rows(), volume.cols(), volume.slices() - 1)) {
+                volume.clear();
+                return false;
             }
+            finishLoad();
+            return true;
         }
+        firstImageIndex = startImg;
+        if (!fitsLattice(volume.rows(), volume.cols(), endImg)) {
+            volume.clear();
+            return false;
+        }
+        
+        std::cout << "Dimensiones de imagen: " << volume.cols() << "x" << volume.rows() << " píxeles" << std::endl;
+        std::cout << "Imágenes cargadas: " << volume.slices() << " (de " << startImg << " a " << endImg << ")" << std::endl;
         
+        finishLoad();
+        return true;
+    }
+    
+    // Estimar la memoria de cargar las páginas [startImg, endImg] con la cabecera y
+    // el índice de páginas y, con 'countPoints', los puntos de la extracción
+    // contando los de unas imágenes repartidas por el rango (con sus vecinas si hay
+    // superficie 3D), que hay que decodificar y extraer; false si el lector por
+    // páginas no soporta el formato (entonces la carga iría por OpenCV y no se
+    // puede acotar)
+    bool estimateLoadMemory(const std::string& filename, bool useMorphological, int startImg, int endImg,
+                            bool countPoints, MemoryEstimate& estimate) {
+        TiffPageReader reader;
+        TiffPageInfo info;
+        if (!reader.open(filename) || !reader.openIndex(persistPageIndex)) {
+            return false;
+        }
+        startImg = std::max(0, startImg);
+        endImg = std::min(reader.pageCount() - 1, endImg);
+        if (startImg > endImg || !reader.pageInfo(startImg, info) || !reader.canDecode(info)) {
+            return false;
+        }
+        estimate = estimateStackMemory(endImg - startImg + 1, info.height, info.width, useRunLength);
+        if (!countPoints) return true;
+        
+        // Las imágenes de muestra no cuentan en las métricas de la ejecución
+        const int SAMPLE_IMAGES = 16;
+        RunMetrics* runMetrics = metrics;
+        metrics = nullptr;
+        int samples = std::min(SAMPLE_IMAGES, estimate.pages);
+        int margin = surfaceConnectivity > 0 ? 1 : 0;
+        size_t sampledPoints = 0;
+        bool sampled = true;
+        for (int i = 0; i < samples && sampled; i++) {
+            int imgIndex = startImg + (int)((2LL * i + 1) * estimate.pages / (2LL * samples));
+            int loadFirst = std::max(startImg, imgIndex - margin);
+            int loadLast = std::min(endImg, imgIndex + margin);
+            sampled = loadPagesPacked(reader, loadFirst, loadLast);
+            if (sampled) {
+                firstImageIndex = loadFirst;
+                finishLoad();
+                sampledPoints += countImagePoints(imgIndex, useMorphological);
+            }
+        }
+        metrics = runMetrics;
+        volume.clear();
+        occupancy.clear();
+        runSlices.clear();
+        firstImageIndex = 0;
+        if (!sampled) return false;
+        
+        estimate.points = (size_t)((double)sampledPoints / samples * estimate.pages);
+        return true;
+    }
+    
+    // Extraer las páginas [startImg, endImg] por bloques de 'chunkPages' imágenes
+    // (--memory-budget): solo un bloque está cargado a la vez, más una imagen a cada
+    // lado con superficie 3D, que necesita las vecinas. Los puntos se añaden a la
+    // nube o a 'pointSink' igual que al extraer la pila completa; 'expectedPoints'
+    // es la estimación de los puntos de la nube.
+    bool extractEdgePointsChunked(const std::string& filename, bool useMorphological,
+                                  int startImg, int endImg, int chunkPages, size_t expectedPoints = 0) {
+        clearPoints();
+        // Reservar la nube estimada evita que crezca duplicándose entre bloques
+        if (!pointSink) pointCloud.reserve(expectedPoints);
+        
+        TiffPageReader reader;
+        if (!reader.open(filename) || !reader.openIndex(persistPageIndex)) {
+            return false;
+        }
+        totalImages = reader.pageCount();
+        startImg = std::max(0, startImg);
+        endImg = std::min(totalImages - 1, endImg);
+        if (startImg > endImg) {
+            std::cerr << "Error: Rango de imágenes vacío" << std::endl;
+            return false;
+        }
+        
+        std::cout << "Extrayendo puntos de borde de imágenes " << startImg << " a " << endImg
+                  << " por bloques de " << chunkPages << " imágenes" << std::endl;
+        
+        int margin = surfaceConnectivity > 0 ? 1 : 0;
+        for (int first = startImg; first <= endImg; first += chunkPages) {
+            int last = std::min(endImg, first + chunkPages - 1);
+            int loadFirst = std::max(startImg, first - margin);
+            int loadLast = std::min(endImg, last + margin);
+            if (!loadPagesPacked(reader, loadFirst, loadLast)) {
+                std::cerr << "Error: No se pudieron decodificar las imágenes " << loadFirst << " a " << loadLast << std::endl;
+                volume.clear();
+                return false;
+            }
+            firstImageIndex = loadFirst;
+            if (!fitsLattice(volume.rows(), volume.cols(), loadLast)) {
+                volume.clear();
+                return false;
+            }
+            finishLoad();
+            extractImages(first, last, useMorphological, 10);
+        }
+        
+        // Liberar el último bloque
+        volume.clear();
+        occupancy.clear();
+        runSlices.clear();
+        
+        std::cout << "Puntos de borde extraídos total: " << stats.count << std::endl;
         return true;
     }
     
     // Extraer puntos de borde de todas las imágenes usando método manual
     void extractEdgePointsManual() {
-        pointCloud.clear();
+        clearPoints();
         
         std::cout << "Extrayendo puntos de borde de " << totalImages << " imágenes..." << std::endl;
         
-        for (int imgIndex = 0; imgIndex < totalImages; imgIndex++) {
-            const cv::Mat& currentImage = images[imgIndex];
+        // Mostrar progreso cada 10 imágenes
+        extractImages(0, totalImages - 1, false, 10);
+        
+        std::cout << "Puntos de borde extraídos total: " << stats.count << std::endl;
+    }
+    
+    // Extraer puntos de borde usando operadores morfológicos
+    void extractEdgePointsMorphological() {
+        clearPoints();
+        
+        std::cout << "Extrayendo puntos de borde con operadores morfológicos de " << totalImages << " imágenes..." << std::endl;
+        
+        // Mostrar progreso cada 10 imágenes
+        extractImages(0, totalImages - 1, true, 10);
+        
+        std::cout << "Puntos de borde extraídos total: " << stats.count << std::endl;
+    }
+    
+    // Extraer puntos de borde de un rango específico de imágenes
+    void extractEdgePointsRange(int startImg, int endImg, bool useMorphological = false) {
+        clearPoints();
+        
+        // Validar rango (limitado a las páginas cargadas)
+        startImg = std::max(firstImageIndex, startImg);
+        endImg = std::min(firstImageIndex + volume.slices() - 1, endImg);
+        
+        std::cout << "Extrayendo puntos de borde de imágenes " << startImg << " a " << endImg << std::endl;
+        
+        extractImages(startImg, endImg, useMorphological, 1);
+        
+        std::cout << "Puntos de borde extraídos: " << stats.count << std::endl;
+    }
+    
+    // Variante paralela del modo streaming: se procesa una ventana de páginas a la vez;
+    // cada hilo decodifica sus páginas con su propio lector y la ventana se escribe
+    // en orden antes de pasar a la siguiente, así la memoria queda acotada por la ventana.
+    bool extractStreamingParallel(const TiffPageReader& index, bool useMorphological,
+                                  int startImg, int endImg, std::ostream* out) {
+        std::vector<TiffPageReader> readers(numThreads);
+        for (auto& reader : readers) {
+            if (!reader.open(index.path())) {
+                return false;
+            }
+            reader.copyIndexFrom(index);
+        }
+        
+        const int window = numThreads * 2;
+        std::vector<std::vector<LatticePoint>> windowPoints(window);
+        std::vector<cv::Mat> pages(numThreads);
+        std::vector<FusedEdgeSweep> sweeps(numThreads);
+        std::atomic<bool> failed(false);
+        cv::Size firstSize;
+        
+        for (int first = startImg; first <= endImg; first += window) {
+            int last = std::min(endImg, first + window - 1);
+            
+            parallelFor(last - first + 1, numThreads, [&](int i, int worker) {
+                int imgIndex = first + i;
+                std::vector<LatticePoint>& points = windowPoints[i];
+                points.clear();
+                {
+                    PhaseTimer timer(metrics, "decode");
+                    if (failed || !readers[worker].readPage(imgIndex, pages[worker])) {
+                        failed = true;
+                        return;
+                    }
+                }
+                countDecodedPage(readers[worker]);
+                if (imgIndex == startImg) {
+                    firstSize = pages[worker].size();
+                }
+                PhaseTimer timer(metrics, "extract");
+                SliceTimer sliceTimer(metrics);
+                extractSliceEdges(pages[worker], imgIndex, useMorphological, points, sweeps[worker]);
+                countScannedPage(pages[worker]);
+            });
+            
+            if (failed) {
+                return false;
+            }
+            if (first == startImg) {
+                std::cout << "Dimensiones de imagen: " << firstSize.width << "x" << firstSize.height << " píxeles" << std::endl;
+            }
+            if (!fitsLattice(firstSize.height, firstSize.width, last)) {
+                return false;
+            }
+            
+            for (int imgIndex = first; imgIndex <= last; imgIndex++) {
+                const std::vector<LatticePoint>& points = windowPoints[imgIndex - first];
+                
+                // Mostrar progreso cada 10 imágenes
+                if (imgIndex % 10 == 0) {
+                    std::cout << "Procesando imagen " << (imgIndex + 1) << std::endl;
+                }
+                
+                emitPoints(points, out);
+            }
+        }
+        return true;
+    }
+    
+    // Superficie 3D en modo streaming: se leen las páginas en orden y solo se guardan
+    // empaquetadas las imágenes z-1, z y z+1 en una ventana rotatoria de tres. La
+    // imagen z se procesa cuando ya se leyó z+1; las vecinas fuera de [startImg, endImg]
+    // cuentan como fuera del volumen. 'imgIndex' queda en la siguiente página sin leer.
+    bool extractSurfaceStreaming(TiffPageReader& reader, bool useMorphological,
+                                 int startImg, int endImg, std::ostream* out, int& imgIndex) {
+        BitVolume window;
+        cv::Mat page;
+        std::vector<LatticePoint> slicePoints;
+        
+        // Procesar la imagen z de la ventana, con 'hasNext' si ya se leyó z+1
+        auto processSlice = [&](int z, bool hasNext) {
+            BitSliceView prev = window.slice((z + 2) % 3), next = window.slice((z + 1) % 3);
+            
+            // Mostrar progreso cada 10 imágenes
+            if (z % 10 == 0) {
+                std::cout << "Procesando imagen " << (z + 1) << std::endl;
+            }
+            
+            slicePoints.clear();
+            {
+                PhaseTimer timer(metrics, "extract");
+                SliceTimer sliceTimer(metrics);
+                extractSliceSurface(z > startImg ? &prev : nullptr, window.slice(z % 3), hasNext ? &next : nullptr,
+                                    z, useMorphological, slicePoints);
+            }
+            if (metrics) metrics->addCounter("pixels_scanned", (long long)window.rows() * window.cols());
+            emitPoints(slicePoints, out);
+        };
+        
+        for (; reader.hasNextPage() && imgIndex <= endImg; imgIndex++) {
+            if (!readNextPageTimed(reader, page) || !fitsLattice(page.rows, page.cols, imgIndex)) {
+                return false;
+            }
+            
+            if (imgIndex == startImg) {
+                std::cout << "Dimensiones de imagen: " << page.cols << "x" << page.rows << " píxeles" << std::endl;
+                window.create(3, page.rows, page.cols);
+            } else if (page.rows != window.rows() || page.cols != window.cols()) {
+                std::cerr << "Error: Las imágenes del TIFF no tienen todas las mismas dimensiones" << std::endl;
+                return false;
+            }
+            window.packSlice(imgIndex % 3, page, 127);
+            
+            if (imgIndex > startImg) {
+                processSlice(imgIndex - 1, true);
+            }
+        }
+        
+        if (imgIndex > startImg) {
+            processSlice(imgIndex - 1, false);
+        }
+        return true;
+    }
+    
+    // Extraer puntos de borde leyendo el TIFF página por página, sin cargar la pila.
+    // Solo se mantiene en memoria la página actual; si se indica 'out', los puntos
+    // de cada imagen se escriben en formato XYZ en cuanto se obtienen.
+    bool extractEdgePointsStreaming(const std::string& filename, bool useMorphological,
+                                    int startImg = 0, int endImg = INT_MAX, std::ostream* out = nullptr) {
+        clearPoints();
+        volume.clear();
+        
+        TiffPageReader reader;
+        if (!reader.open(filename)) {
+            return false;
+        }
+        
+        startImg = std::max(0, startImg);
+        std::cout << "Extrayendo puntos de borde en modo streaming: " << filename << std::endl;
+        
+        // Con un rango, con índice persistente o con varios hilos se usa el índice de
+        // páginas para saltar directamente a la primera página del rango
+        bool useIndex = persistPageIndex || numThreads > 1 || startImg > 0 || endImg != INT_MAX;
+        if (useIndex) {
+            if (!reader.openIndex(persistPageIndex)) {
+                return false;
+            }
+            endImg = std::min(endImg, reader.pageCount() - 1);
+            if (!reader.seekPage(std::min(startImg, reader.pageCount()))) {
+                std::cerr << "Error: Rango de imágenes vacío" << std::endl;
+                return false;
+            }
+        }
+        
+        cv::Mat page;
+        FusedEdgeSweep sweep;
+        std::vector<LatticePoint> slicePoints;
+        int imgIndex = useIndex ? startImg : 0;
+        
+        if (surfaceConnectivity > 0) {
+            if (!extractSurfaceStreaming(reader, useMorphological, startImg, endImg, out, imgIndex)) {
+                return false;
+            }
+        } else if (numThreads > 1) {
+            if (!extractStreamingParallel(reader, useMorphological, startImg, endImg, out)) {
+                return false;
+            }
+            imgIndex = endImg + 1;
+        }
+        
+        for (; reader.hasNextPage() && imgIndex <= endImg; imgIndex++) {
+            // Fuera del rango solo se recorre el IFD, sin decodificar la imagen
+            if (imgIndex < startImg || imgIndex > endImg) {
+                if (!reader.skipPage()) return false;
+                continue;
+            }
+            
+            if (!readNextPageTimed(reader, page) || !fitsLattice(page.rows, page.cols, imgIndex)) {
+                return false;
+            }
+            
+            if (imgIndex == startImg) {
+                std::cout << "Dimensiones de imagen: " << page.cols << "x" << page.rows << " píxeles" << std::endl;
+            }
             
             // Mostrar progreso cada 10 imágenes
             if (imgIndex % 10 == 0) {
-                std::cout << "Procesando imagen " << (imgIndex + 1) << "/" << totalImages << std::endl;
+                std::cout << "Procesando imagen " << (imgIndex + 1) << std::endl;
             }
             
-            for (int row = 0; row < currentImage.rows; row++) {
-                for (int col = 0; col < currentImage.cols; col++) {
-                    if (isEdgePixel(currentImage, row, col)) {
-                        // Convertir coordenadas de imagen a coordenadas del mundo
-                        double x = col;
-                        double y = currentImage.rows - row; // Invertir Y para coordenadas estándar
-                        double z = imgIndex; // Número de imagen (0-based)
-                        
-                        pointCloud.push_back(Point3D(x, y, z));
-                    }
+            slicePoints.clear();
+            {
+                PhaseTimer timer(metrics, "extract");
+                SliceTimer sliceTimer(metrics);
+                extractSliceEdges(page, imgIndex, useMorphological, slicePoints, sweep);
+            }
+            countScannedPage(page);
+            
+            emitPoints(slicePoints, out);
+        }
+        
+        totalImages = useIndex ? reader.pageCount() : imgIndex;
+        if (totalImages == 0) {
+            std::cerr << "Error: El archivo " << filename << " no contiene imágenes" << std::endl;
+            return false;
+        }
+        
+        std::cout << "Número total de imágenes encontradas: " << totalImages << std::endl;
+        std::cout << "Puntos de borde extraídos total: " << stats.count << std::endl;
+        return true;
+    }
+    
+    // Extraer en una sola pasada los bordes de todas las etiquetas de un volumen
+    // multi-etiqueta (páginas de 8 o 16 bits, 0 = fondo), leyendo página por página.
+    // Un vóxel es borde de su etiqueta L si alguno de sus 8 vecinos en la imagen
+    // tiene otra etiqueta. Si se indica 'out', los puntos se escriben etiquetados
+    // (x y z etiqueta) a medida que se extraen y solo se guardan en la nube con
+    // 'keepPoints' (para saveLabelFiles); así la memoria no crece con los puntos.
+    bool extractLabelEdgesStreaming(const std::string& filename, bool useMorphological,
+                                    int startImg = 0, int endImg = INT_MAX, std::ostream* out = nullptr,
+                                    bool keepPoints = false) {
+        clearPoints();
+        volume.clear();
+        
+        TiffPageReader reader;
+        if (!reader.open(filename)) {
+            return false;
+        }
+        
+        startImg = std::max(0, startImg);
+        std::cout << "Extrayendo bordes de todas las etiquetas: " << filename << std::endl;
+        
+        bool useIndex = persistPageIndex || startImg > 0 || endImg != INT_MAX;
+        if (useIndex) {
+            if (!reader.openIndex(persistPageIndex)) {
+                return false;
+            }
+            endImg = std::min(endImg, reader.pageCount() - 1);
+            if (!reader.seekPage(std::min(startImg, reader.pageCount()))) {
+                std::cerr << "Error: Rango de imágenes vacío" << std::endl;
+                return false;
+            }
+        }
+        
+        cv::Mat page;
+        std::vector<LatticePoint> slicePoints;
+        std::vector<uint16_t> sliceLabels;
+        std::vector<uint64_t> edgeBits;
+        std::map<int, size_t> labelCounts;
+        keepPoints = keepPoints || !out;
+        int imgIndex = useIndex ? startImg : 0;
+        
+        for (; reader.hasNextPage() && imgIndex <= endImg; imgIndex++) {
+            // Las etiquetas de 16 bits se conservan sin convertir a 8 bits
+            if (!readNextPageTimed(reader, page, cv::IMREAD_UNCHANGED) || !fitsLattice(page.rows, page.cols, imgIndex)) {
+                return false;
+            }
+            
+            if (imgIndex == startImg) {
+                std::cout << "Dimensiones de imagen: " << page.cols << "x" << page.rows << " píxeles ("
+                          << (page.depth() == CV_16U ? 16 : 8) << " bits)" << std::endl;
+            }
+            
+            // Mostrar progreso cada 10 imágenes
+            if (imgIndex % 10 == 0) {
+                std::cout << "Procesando imagen " << (imgIndex + 1) << std::endl;
+            }
+            
+            slicePoints.clear();
+            sliceLabels.clear();
+            {
+                PhaseTimer timer(metrics, "extract");
+                SliceTimer sliceTimer(metrics);
+                if (page.depth() == CV_16U) {
+                    extractLabelSlice<uint16_t>(page, imgIndex, useMorphological, slicePoints, sliceLabels, edgeBits);
+                } else {
+                    extractLabelSlice<uchar>(page, imgIndex, useMorphological, slicePoints, sliceLabels, edgeBits);
                 }
             }
+            countScannedPage(page);
+            
+            if (out) {
+                writeLabelledPoints(*out, slicePoints, sliceLabels);
+            }
+            stats.add(slicePoints);
+            for (uint16_t label : sliceLabels) labelCounts[label]++;
+            if (keepPoints) {
+                pointCloud.insert(pointCloud.end(), slicePoints.begin(), slicePoints.end());
+                pointLabels.insert(pointLabels.end(), sliceLabels.begin(), sliceLabels.end());
+            }
         }
         
-        std::cout << "Puntos de borde extraídos total: " << pointCloud.size() << std::endl;
+        totalImages = useIndex ? reader.pageCount() : imgIndex;
+        if (totalImages == 0) {
+            std::cerr << "Error: El archivo " << filename << " no contiene imágenes" << std::endl;
+            return false;
+        }
+        
+        std::cout << "Número total de imágenes encontradas: " << totalImages << std::endl;
+        std::cout << "Etiquetas encontradas: " << labelCounts.size() << std::endl;
+        for (const auto& entry : labelCounts) {
+            std::cout << "  Etiqueta " << entry.first << ": " << entry.second << " puntos" << std::endl;
+        }
+        std::cout << "Puntos de borde extraídos total: " << stats.count << std::endl;
+        return true;
     }
     
-    // Extraer puntos de borde usando operadores morfológicos
-    void extractEdgePointsMorphological() {
-        pointCloud.clear();
+    // Guardar los puntos de cada etiqueta en su propio archivo XYZ:
+    // prefix + "_label<L>" + suffix
+    bool saveLabelFiles(const std::string& prefix, const std::string& suffix) {
+        std::map<int, std::vector<LatticePoint>> byLabel;
+        for (size_t i = 0; i < pointCloud.size() && i < pointLabels.size(); i++) {
+            byLabel[pointLabels[i]].push_back(pointCloud[i]);
+        }
         
-        std::cout << "Extrayendo puntos de borde con operadores morfológicos de " << totalImages << " imágenes..." << std::endl;
+        for (const auto& entry : byLabel) {
+            std::string filename = prefix + "_label" + std::to_string(entry.first) + suffix;
+            std::ofstream file(filename);
+            if (!file.is_open()) {
+                std::cerr << "Error: No se pudo crear el archivo " << filename << std::endl;
+                return false;
+            }
+            writePoints(file, entry.second);
+            std::cout << "Etiqueta " << entry.first << " guardada en: " << filename << std::endl;
+        }
+        return true;
+    }
+    
+    // Generar una malla de triángulos por marching cubes leyendo el TIFF página por
+    // página: cada página se malla junto con la anterior en cuanto se decodifica y
+    // la malla se escribe en formato OBJ a medida que avanza. Solo se guardan dos
+    // imágenes; las páginas fuera de [startImg, endImg] cuentan como fondo.
+    bool extractMeshStreaming(const std::string& filename, int startImg, int endImg, std::ostream& out) {
+        TiffPageReader reader;
+        if (!reader.open(filename)) {
+            return false;
+        }
+        
+        startImg = std::max(0, startImg);
+        std::cout << "Generando malla por marching cubes: " << filename << std::endl;
         
-        for (int imgIndex = 0; imgIndex < totalImages; imgIndex++) {
-            const cv::Mat& currentImage = images[imgIndex];
-            cv::Mat edges = detectEdgesMorphological(currentImage);
+        if (startImg > 0 || endImg != INT_MAX) {
+            if (!reader.openIndex(persistPageIndex)) {
+                return false;
+            }
+            endImg = std::min(endImg, reader.pageCount() - 1);
+            if (!reader.seekPage(std::min(startImg, reader.pageCount()))) {
+                std::cerr << "Error: Rango de imágenes vacío" << std::endl;
+                return false;
+            }
+        }
+        
+        StreamingMesher mesher;
+        cv::Mat page;
+        int imgIndex = startImg;
+        for (; reader.hasNextPage() && imgIndex <= endImg; imgIndex++) {
+            if (!readNextPageTimed(reader, page)) {
+                return false;
+            }
+            
+            if (imgIndex == startImg) {
+                std::cout << "Dimensiones de imagen: " << page.cols << "x" << page.rows << " píxeles" << std::endl;
+                mesher.begin(out, page.rows, page.cols, startImg);
+            } else if (page.rows != mesher.rows() || page.cols != mesher.cols()) {
+                std::cerr << "Error: Las imágenes del TIFF no tienen todas las mismas dimensiones" << std::endl;
+                return false;
+            }
             
             // Mostrar progreso cada 10 imágenes
             if (imgIndex % 10 == 0) {
-                std::cout << "Procesando imagen " << (imgIndex + 1) << "/" << totalImages << std::endl;
+                std::cout << "Procesando imagen " << (imgIndex + 1) << std::endl;
+            }
+            
+            PhaseTimer timer(metrics, "mesh");
+            SliceTimer sliceTimer(metrics);
+            mesher.addSlice(page, 127);
+        }
+        
+        if (imgIndex == startImg) {
+            std::cerr << "Error: El archivo " << filename << " no contiene imágenes" << std::endl;
+            return false;
+        }
+        mesher.finish();
+        if (metrics) {
+            metrics->addCounter("mesh_vertices", (long long)mesher.vertices());
+            metrics->addCounter("mesh_triangles", (long long)mesher.triangles());
+        }
+        
+        std::cout << "Imágenes malladas: " << (imgIndex - startImg) << std::endl;
+        std::cout << "Vértices: " << mesher.vertices() << std::endl;
+        std::cout << "Triángulos: " << mesher.triangles() << std::endl;
+        return true;
+    }
+    
+    // Extraer los contornos ordenados de cada imagen (exteriores y agujeros, ver
+    // slice_contours.h) leyendo el TIFF página por página y escribiéndolos en 'out'.
+    // Con 'tolerances' se escribe un nivel de detalle simplificado por tolerancia.
+    bool extractContoursStreaming(const std::string& filename, int startImg, int endImg,
+                                  const std::vector<double>& tolerances, std::ostream& out) {
+        TiffPageReader reader;
+        if (!reader.open(filename)) {
+            return false;
+        }
+        
+        startImg = std::max(0, startImg);
+        std::cout << "Extrayendo contornos: " << filename << std::endl;
+        
+        if (startImg > 0 || endImg != INT_MAX) {
+            if (!reader.openIndex(persistPageIndex)) {
+                return false;
+            }
+            endImg = std::min(endImg, reader.pageCount() - 1);
+            if (!reader.seekPage(std::min(startImg, reader.pageCount()))) {
+                std::cerr << "Error: Rango de imágenes vacío" << std::endl;
+                return false;
+            }
+        }
+        
+        ContourWriter writer;
+        writer.setLevels(tolerances);
+        writer.begin(out);
+        cv::Mat page;
+        int imgIndex = startImg;
+        for (; reader.hasNextPage() && imgIndex <= endImg; imgIndex++) {
+            if (!readNextPageTimed(reader, page)) {
+                return false;
+            }
+            if (imgIndex == startImg) {
+                std::cout << "Dimensiones de imagen: " << page.cols << "x" << page.rows << " píxeles" << std::endl;
+            }
+            
+            // Mostrar progreso cada 10 imágenes
+            if (imgIndex % 10 == 0) {
+                std::cout << "Procesando imagen " << (imgIndex + 1) << std::endl;
             }
             
-            for (int row = 0; row < edges.rows; row++) {
-                for (int col = 0; col < edges.cols; col++) {
-                    if (edges.at<uchar>(row, col) > 0) {
-                        double x = col;
-                        double y = edges.rows - row;
-                        double z = imgIndex; // Número de imagen (0-based)
-                        
-                        pointCloud.push_back(Point3D(x, y, z));
-                    }
-                }
-            }
+            PhaseTimer timer(metrics, "contours");
+            SliceTimer sliceTimer(metrics);
+            writer.addSlice(page, imgIndex, 127);
+        }
+        
+        if (imgIndex == startImg) {
+            std::cerr << "Error: El archivo " << filename << " no contiene imágenes" << std::endl;
+            return false;
+        }
+        writer.finish();
+        if (metrics) {
+            metrics->addCounter("contours", writer.contourTotal());
+            metrics->addCounter("contour_points", writer.points());
         }
         
-        std::cout << "Puntos de borde extraídos total: " << pointCloud.size() << std::endl;
+        std::cout << "Imágenes procesadas: " << (imgIndex - startImg) << std::endl;
+        std::cout << "Contornos: " << writer.contourTotal() << " (" << writer.holes() << " agujeros)" << std::endl;
+        std::cout << "Puntos de contorno: " << writer.points() << std::endl;
+        for (int level = 0; level < writer.levels(); level++) {
+            long long points = writer.levelPoints(level);
+            std::cout << "  Nivel " << level << " (tolerancia " << writer.levelTolerance(level) << " px): "
+                      << points << " puntos";
+            if (points > 0) {
+                std::cout << " (" << (double)writer.points() / points << "x menos)";
+            }
+            std::cout << std::endl;
+        }
+        return true;
     }
     
-    // Extraer puntos de borde de un rango específico de imágenes
-    void extractEdgePointsRange(int startImg, int endImg, bool useMorphological = false) {
-        pointCloud.clear();
-        
-        // Validar rango
-        startImg = std::max(0, startImg);
-        endImg = std::min(totalImages - 1, endImg);
+    // Escribir la cabecera y los registros float de la nube en un archivo proyectado
+    // en memoria: el tamaño se conoce de antemano, así que cada hilo convierte su
+    // tramo de puntos directamente en su región del archivo, sin búfer intermedio
+    // (y la libera al terminarla, para que el archivo no ocupe memoria residente)
+    bool saveBinaryPointFile(const std::string& filename, const std::string& header) {
+        MappedOutputFile file;
+        if (!file.create(filename, header.size() + pointCloud.size() * BINARY_POINT_BYTES)) {
+            std::cerr << "Error: No se pudo crear el archivo " << filename << std::endl;
+            return false;
+        }
+        std::memcpy(file.data(), header.data(), header.size());
         
-        std::cout << "Extrayendo puntos de borde de imágenes " << startImg << " a " << endImg << std::endl;
+        const size_t CHUNK_POINTS = 1 << 16;
+        unsigned char* records = file.data() + header.size();
+        int chunks = (int)((pointCloud.size() + CHUNK_POINTS - 1) / CHUNK_POINTS);
+        parallelFor(chunks, numThreads, [&](int chunk, int) {
+            size_t first = (size_t)chunk * CHUNK_POINTS;
+            size_t count = std::min(CHUNK_POINTS, pointCloud.size() - first);
+            storeBinaryPoints(pointCloud.data() + first, count, records + first * BINARY_POINT_BYTES);
+            file.release(header.size() + first * BINARY_POINT_BYTES, count * BINARY_POINT_BYTES);
+        });
         
-        for (int imgIndex = startImg; imgIndex <= endImg; imgIndex++) {
-            const cv::Mat& currentImage = images[imgIndex];
-            
-            std::cout << "Procesando imagen " << (imgIndex + 1) << "/" << totalImages << std::endl;
-            
-            if (useMorphological) {
-                cv::Mat edges = detectEdgesMorphological(currentImage);
-                
-                for (int row = 0; row < edges.rows; row++) {
-                    for (int col = 0; col < edges.cols; col++) {
-                        if (edges.at<uchar>(row, col) > 0) {
-                            double x = col;
-                            double y = edges.rows - row;
-                            double z = imgIndex;
-                            
-                            pointCloud.push_back(Point3D(x, y, z));
-                        }
-                    }
-                }
-            } else {
-                for (int row = 0; row < currentImage.rows; row++) {
-                    for (int col = 0; col < currentImage.cols; col++) {
-                        if (isEdgePixel(currentImage, row, col)) {
-                            double x = col;
-                            double y = currentImage.rows - row;
-                            double z = imgIndex;
-                            
-                            pointCloud.push_back(Point3D(x, y, z));
-                        }
-                    }
-                }
-            }
+        if (!file.close()) {
+            std::cerr << "Error: No se pudo escribir el archivo " << filename << std::endl;
+            return false;
         }
-        
-        std::cout << "Puntos de borde extraídos: " << pointCloud.size() << std::endl;
+        std::cout << "Nube de puntos guardada en: " << filename << std::endl;
+        return true;
     }
     
-    // Guardar nube de puntos en formato PLY
-    bool savePointCloudPLY(const std::string& filename) {
-        std::ofstream file(filename);
+    // Guardar nube de puntos en formato PLY (ASCII o binary_little_endian)
+    bool savePointCloudPLY(const std::string& filename, bool binary = false) {
+        if (binary) {
+            std::ostringstream header;
+            writeBinaryPLYHeader(header, pointCloud.size());
+            return saveBinaryPointFile(filename, header.str());
+        }
+        
+        std::ofstream file(filename, std::ios::binary);
         if (!file.is_open()) {
             std::cerr << "Error: No se pudo crear el archivo " << filename << std::endl;
             return false;
@@ -228,15 +1453,56 @@ public:
         file << "end_header\n";
         
         // Escribir puntos
-        for (const auto& point : pointCloud) {
-            file << point.x << " " << point.y << " " << point.z << "\n";
-        }
+        writePoints(file, pointCloud);
         
         file.close();
         std::cout << "Nube de puntos guardada en: " << filename << std::endl;
         return true;
     }
     
+    // Guardar nube de puntos comprimida con el octree de ocupación (.oct); los
+    // subárboles se codifican en paralelo con los hilos configurados
+    bool savePointCloudOctree(const std::string& filename) {
+        std::vector<uint8_t> encoded;
+        if (!encodeOctree(pointCloud, encoded, numThreads)) {
+            return false;
+        }
+        
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: No se pudo crear el archivo " << filename << std::endl;
+            return false;
+        }
+        file.write((const char*)encoded.data(), (std::streamsize)encoded.size());
+        file.close();
+        if (!file) {
+            std::cerr << "Error: No se pudo escribir el archivo " << filename << std::endl;
+            return false;
+        }
+        std::cout << "Nube de puntos guardada en: " << filename << " ("
+                  << (pointCloud.empty() ? 0.0 : encoded.size() * 8.0 / pointCloud.size()) << " bits por punto)" << std::endl;
+        return true;
+    }
+    
+    // Guardar nube de puntos en formato compacto (.edg)
+    bool savePointCloudCompact(const std::string& filename) {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: No se pudo crear el archivo " << filename << std::endl;
+            return false;
+        }
+        
+        CompactPointWriter writer;
+        writer.writeSlice(file, pointCloud);
+        bool encoded = writer.finish(file);
+        file.close();
+        if (!encoded || !file) {
+            std::cerr << "Error: No se pudo escribir el archivo " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
     // Guardar nube de puntos en formato XYZ
     bool savePointCloudXYZ(const std::string& filename) {
         std::ofstream file(filename);
@@ -245,18 +1511,24 @@ public:
             return false;
         }
         
-        for (const auto& point : pointCloud) {
-            file << point.x << " " << point.y << " " << point.z << "\n";
-        }
+        writePoints(file, pointCloud);
         
         file.close();
-        std::cout << "Nube de puntos guardada en: " << filename << std::endl;
+        if (verbose) {
+            std::cout << "Nube de puntos guardada en: " << filename << std::endl;
+        }
         return true;
     }
     
-    // Guardar nube de puntos en formato PCD (Point Cloud Data)
-    bool savePointCloudPCD(const std::string& filename) {
-        std::ofstream file(filename);
+    // Guardar nube de puntos en formato PCD (Point Cloud Data, ASCII o DATA binary)
+    bool savePointCloudPCD(const std::string& filename, bool binary = false) {
+        if (binary) {
+            std::ostringstream header;
+            writeBinaryPCDHeader(header, pointCloud.size());
+            return saveBinaryPointFile(filename, header.str());
+        }
+        
+        std::ofstream file(filename, std::ios::binary);
         if (!file.is_open()) {
             std::cerr << "Error: No se pudo crear el archivo " << filename << std::endl;
             return false;
@@ -276,9 +1548,7 @@ public:
         file << "DATA ascii\n";
         
         // Escribir puntos
-        for (const auto& point : pointCloud) {
-            file << point.x << " " << point.y << " " << point.z << "\n";
-        }
+        writePoints(file, pointCloud);
         
         file.close();
         std::cout << "Nube de puntos guardada en: " << filename << std::endl;
@@ -289,11 +1559,17 @@ public:
     bool saveEdgeImages(const std::string& baseName, int maxImages = 10) {
         std::cout << "Guardando imágenes de bordes (máximo " << maxImages << ")..." << std::endl;
         
-        int imagesToSave = std::min(maxImages, totalImages);
+        int imagesToSave = std::min(maxImages, volume.slices());
         
         for (int i = 0; i < imagesToSave; i++) {
-            cv::Mat edges = detectEdgesMorphological(images[i]);
-            std::string filename = baseName + "_edges_" + std::to_string(i) + ".png";
+            // Bordes morfológicos (imagen menos su erosión) calculados sobre el volumen empaquetado
+            BitSliceView slice = volume.slice(i);
+            cv::Mat edges = cv::Mat::zeros(slice.rows, slice.cols, CV_8UC1);
+            forEachEdgeRowOccupied(slice, occupancy[i], ~0ULL, [&](int row, const uint64_t* edgeBits) {
+                uchar* dst = edges.ptr<uchar>(row);
+                forEachSetBit(edgeBits, slice.wordsPerRow, [&](int col) { dst[col] = 255; });
+            });
+            std::string filename = baseName + "_edges_" + std::to_string(firstImageIndex + i) + ".png";
             
             if (!cv::imwrite(filename, edges)) {
                 std::cerr << "Error guardando imagen: " << filename << std::endl;
@@ -305,114 +1581,937 @@ public:
         return true;
     }
     
+    // Modo por lotes: procesar varias pilas en un solo proceso con un único conjunto
+    // de hilos. Primero se cargan las pilas (una tarea por pila, las más grandes
+    // primero) y después se reparten entre los hilos todas las imágenes de todas
+    // las pilas, de modo que ningún hilo queda ocioso mientras quede trabajo.
+    // Cada pila se guarda en su propio 'outputs[i]' y se escribe un resumen CSV.
+    // Con 'metrics' las fases y contadores de todas las pilas se suman.
+    static bool runBatch(const std::vector<std::string>& files, const std::vector<std::string>& outputs,
+                         bool useMorphological, int threads, bool runLength, int connectivity,
+                         const std::string& summaryFile, RunMetrics* metrics = nullptr) {
+        auto startTime = std::chrono::steady_clock::now();
+        const int count = (int)files.size();
+        if (threads <= 0) {
+            threads = std::max(1, (int)std::thread::hardware_concurrency());
+        }
+        
+        std::vector<std::unique_ptr<MultiTiffEdgeExtractor>> stacks(count);
+        std::vector<char> loaded(count, 0);
+        for (int i = 0; i < count; i++) {
+            stacks[i].reset(new MultiTiffEdgeExtractor());
+            stacks[i]->setVerbose(false);
+            stacks[i]->setRunLengthKernel(runLength);
+            stacks[i]->setSurfaceConnectivity(connectivity);
+            stacks[i]->setMetrics(metrics);
+        }
+        
+        // Cargar primero las pilas más grandes para equilibrar la carga
+        std::vector<int> loadOrder(count);
+        std::vector<long long> fileSizes(count, 0);
+        for (int i = 0; i < count; i++) {
+            loadOrder[i] = i;
+            std::ifstream file(files[i], std::ios::binary | std::ios::ate);
+            if (file.good()) fileSizes[i] = (long long)file.tellg();
+        }
+        std::stable_sort(loadOrder.begin(), loadOrder.end(), [&](int a, int b) { return fileSizes[a] > fileSizes[b]; });
+        
+        std::mutex outputMutex;
+        parallelFor(count, threads, [&](int k, int) {
+            int i = loadOrder[k];
+            loaded[i] = stacks[i]->loadMultiTiffImage(files[i]);
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << (loaded[i] ? "Cargado: " : "Error al cargar: ") << files[i] << std::endl;
+        });
+        
+        // Todas las imágenes de todas las pilas en una sola lista de tareas
+        std::vector<int> firstTask(count + 1, 0);
+        std::vector<std::vector<size_t>> offsets(count);
+        for (int i = 0; i < count; i++) {
+            int images = loaded[i] ? stacks[i]->totalImages : 0;
+            offsets[i].assign(images + 1, 0);
+            firstTask[i + 1] = firstTask[i] + images;
+        }
+        auto taskStack = [&](int task) {
+            return (int)(std::upper_bound(firstTask.begin(), firstTask.end(), task) - firstTask.begin()) - 1;
+        };
+        
+        // Dos pasadas, como extractImagesInPlace: contar, dimensionar cada nube y llenarla
+        std::cout << "Extrayendo " << firstTask[count] << " imágenes de " << count << " pilas con "
+                  << threads << " hilos..." << std::endl;
+        {
+            PhaseTimer timer(metrics, "extract_count");
+            parallelFor(firstTask[count], threads, [&](int task, int) {
+                int i = taskStack(task);
+                int imgIndex = task - firstTask[i];
+                offsets[i][imgIndex + 1] = stacks[i]->countImagePoints(imgIndex, useMorphological);
+            });
+            for (int i = 0; i < count; i++) {
+                if (loaded[i]) stacks[i]->allocateImageRegions(offsets[i]);
+            }
+        }
+        {
+            PhaseTimer timer(metrics, "extract_fill");
+            parallelFor(firstTask[count], threads, [&](int task, int) {
+                int i = taskStack(task);
+                int imgIndex = task - firstTask[i];
+                SliceTimer sliceTimer(metrics);
+                stacks[i]->fillImage(imgIndex, useMorphological, offsets[i][imgIndex]);
+            });
+        }
+        
+        // Guardar cada pila (también en paralelo, una tarea por pila)
+        std::vector<char> saved(count, 0);
+        {
+            PhaseTimer timer(metrics, "write");
+            parallelFor(count, threads, [&](int i, int) {
+                if (!loaded[i]) return;
+                MultiTiffEdgeExtractor& stack = *stacks[i];
+                stack.stats.add(stack.pointCloud);
+                saved[i] = stack.savePointCloudXYZ(outputs[i]);
+                if (metrics) metrics->addCounter("points", (long long)stack.stats.count);
+            });
+        }
+        
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        
+        // Resumen por pila
+        std::ofstream summary(summaryFile);
+        if (!summary.is_open()) {
+            std::cerr << "Error: No se pudo crear el archivo " << summaryFile << std::endl;
+        }
+        summary << "archivo,imagenes,ancho,alto,puntos,salida" << std::endl;
+        
+        std::cout << "\n=== Resumen del lote ===" << std::endl;
+        int failures = 0;
+        for (int i = 0; i < count; i++) {
+            const MultiTiffEdgeExtractor& stack = *stacks[i];
+            bool ok = loaded[i] && saved[i];
+            failures += ok ? 0 : 1;
+            
+            std::cout << std::left << std::setw(40) << files[i] << std::right;
+            if (ok) {
+                std::cout << std::setw(6) << stack.totalImages << " imágenes " << std::setw(10)
+                          << stack.pointCloud.size() << " puntos" << std::endl;
+            } else {
+                std::cout << "  ERROR" << std::endl;
+            }
+            summary << files[i] << "," << (ok ? stack.totalImages : 0) << "," << stack.volume.cols() << ","
+                    << stack.volume.rows() << "," << (ok ? stack.pointCloud.size() : 0) << ","
+                    << (ok ? outputs[i] : "") << std::endl;
+        }
+        std::cout << "Pilas procesadas: " << (count - failures) << "/" << count << std::endl;
+        std::cout << "Tiempo total: " << seconds << " s" << std::endl;
+        std::cout << "Resumen guardado en: " << summaryFile << std::endl;
+        return failures == 0;
+    }
+    
+    // Leer una nube de puntos de archivo: octree (.oct), compacto (.edg), PLY/PCD
+    // binario o texto con una línea "x y z" por punto (XYZ, PLY/PCD ASCII)
+    static bool loadPointFile(const std::string& filename, std::vector<LatticePoint>& points, int threads) {
+        MappedFile mapped;
+        if (!mapped.open(filename)) {
+            std::cerr << "Error: No se pudo abrir el archivo " << filename << std::endl;
+            return false;
+        }
+        
+        // Se lee como float y luego se pasa a la rejilla
+        struct WorldPoint {
+            float x, y, z;
+        };
+        std::vector<WorldPoint> world;
+        PointFileLayout layout;
+        if (isOctreeFile(mapped.data(), mapped.size())) {
+            if (!decodeOctree(mapped.data(), mapped.size(), world, threads)) return false;
+        } else if (isCompactPointFile(mapped.data(), mapped.size())) {
+            CompactPointReader reader;
+            if (!reader.open(mapped.data(), mapped.size()) || !reader.decodeAll(world)) return false;
+        } else if (!parsePointFileLayout(mapped.data(), mapped.size(), layout)) {
+            return false;
+        } else if (layout.format != PointFileFormat::Ascii) {
+            loadBinaryPoints(mapped.data(), layout, world);
+        } else {
+            size_t pos = layout.dataOffset;
+            std::string line;
+            WorldPoint point;
+            while (nextHeaderLine(mapped.data(), mapped.size(), pos, line)) {
+                if (std::sscanf(line.c_str(), "%f %f %f", &point.x, &point.y, &point.z) == 3) {
+                    world.push_back(point);
+                }
+            }
+        }
+        
+        // Solo se aceptan coordenadas enteras en [0, 65535], como las del extractor
+        auto onLattice = [](float value) {
+            return value >= 0 && value <= LatticePoint::LATTICE_LIMIT && value == std::floor(value);
+        };
+        points.clear();
+        points.reserve(world.size());
+        for (const auto& point : world) {
+            if (!onLattice(point.x) || !onLattice(point.y) || !onLattice(point.z)) {
+                std::cerr << "Error: La nube " << filename << " tiene coordenadas fuera de la rejilla de vóxeles ("
+                          << point.x << ", " << point.y << ", " << point.z << ")" << std::endl;
+                return false;
+            }
+            points.push_back(LatticePoint((int)point.x, (int)point.y, (int)point.z));
+        }
+        return true;
+    }
+    
+    // Submuestrear la nube en memoria (rejilla de vóxeles o Poisson-disk) antes de
+    // guardarla y recalcular las estadísticas
+    void subsamplePoints(const PointSampling& sampling) {
+        if (!sampling.enabled()) return;
+        PhaseTimer timer(metrics, "subsample");
+        auto startTime = std::chrono::steady_clock::now();
+        size_t before = pointCloud.size();
+        
+        std::ostringstream method;
+        if (sampling.cellSize > 0) {
+            voxelGridSample(pointCloud, sampling.cellSize, sampling.seed, numThreads);
+            method << "rejilla de vóxeles, celda " << sampling.cellSize;
+        } else {
+            double radius = poissonDiskSample(pointCloud, sampling.targetCount, sampling.seed, numThreads);
+            method << "Poisson-disk, radio " << radius << ", semilla " << sampling.seed;
+        }
+        stats = PointStats();
+        stats.add(pointCloud);
+        
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        std::cout << "Submuestreo (" << method.str() << "): " << before << " -> " << pointCloud.size()
+                  << " puntos en " << seconds << " s" << std::endl;
+    }
+    
+    // Convertir una nube de puntos de un formato a otro; el de salida se elige por la
+    // extensión: .oct (octree), .edg (compacto), .ply/.pcd (binarios) o .xyz, y
+    // submuestrearla por el camino si se pide
+    static bool convertPointFile(const std::string& input, const std::string& output, int threads,
+                                 const PointSampling& sampling) {
+        MultiTiffEdgeExtractor converter;
+        converter.setNumThreads(threads);
+        if (!loadPointFile(input, converter.pointCloud, converter.numThreads)) {
+            std::cerr << "Error: No se pudo leer la nube de puntos " << input << std::endl;
+            return false;
+        }
+        std::cout << "Puntos leídos: " << converter.pointCloud.size() << std::endl;
+        converter.subsamplePoints(sampling);
+        
+        std::string extension = output.substr(output.find_last_of('.') + 1);
+        if (extension == "edg") {
+            // El formato compacto agrupa por imagen y fila: ordenar en orden raster
+            // (el octree, por ejemplo, devuelve los puntos en orden de Morton)
+            std::stable_sort(converter.pointCloud.begin(), converter.pointCloud.end(),
+                             [](const LatticePoint& a, const LatticePoint& b) {
+                                 return a.rasterKey() < b.rasterKey();
+                             });
+        }
+        
+        bool saved;
+        if (extension == "oct") saved = converter.savePointCloudOctree(output);
+        else if (extension == "edg") saved = converter.savePointCloudCompact(output);
+        else if (extension == "ply") saved = converter.savePointCloudPLY(output, true);
+        else if (extension == "pcd") saved = converter.savePointCloudPCD(output, true);
+        else saved = converter.savePointCloudXYZ(output);
+        return saved;
+    }
+    
     // Obtener estadísticas de la nube de puntos
     void printStatistics() {
-        if (pointCloud.empty()) {
+        if (stats.count == 0) {
             std::cout << "No hay puntos en la nube" << std::endl;
             return;
         }
         
-        double minX = pointCloud[0].x, maxX = pointCloud[0].x;
-        double minY = pointCloud[0].y, maxY = pointCloud[0].y;
-        double minZ = pointCloud[0].z, maxZ = pointCloud[0].z;
-        
-        for (const auto& point : pointCloud) {
-            minX = std::min(minX, point.x);
-            maxX = std::max(maxX, point.x);
-            minY = std::min(minY, point.y);
-            maxY = std::max(maxY, point.y);
-            minZ = std::min(minZ, point.z);
-            maxZ = std::max(maxZ, point.z);
-        }
-        
         std::cout << "\n=== Estadísticas de la nube de puntos ===" << std::endl;
-        std::cout << "Número total de puntos: " << pointCloud.size() << std::endl;
+        std::cout << "Número total de puntos: " << stats.count << std::endl;
         std::cout << "Número de imágenes procesadas: " << totalImages << std::endl;
-        std::cout << "Promedio de puntos por imagen: " << (double)pointCloud.size() / totalImages << std::endl;
-        std::cout << "Rango X: [" << minX << ", " << maxX << "]" << std::endl;
-        std::cout << "Rango Y: [" << minY << ", " << maxY << "]" << std::endl;
-        std::cout << "Rango Z: [" << minZ << ", " << maxZ << "]" << std::endl;
+        std::cout << "Promedio de puntos por imagen: " << (double)stats.count / totalImages << std::endl;
+        std::cout << "Rango X: [" << stats.minX << ", " << stats.maxX << "]" << std::endl;
+        std::cout << "Rango Y: [" << stats.minY << ", " << stats.maxY << "]" << std::endl;
+        std::cout << "Rango Z: [" << stats.minZ << ", " << stats.maxZ << "]" << std::endl;
     }
     
     // Obtener información del archivo TIFF
     void printTiffInfo() {
-        if (images.empty()) {
+        if (volume.empty()) {
             std::cout << "No hay imágenes cargadas" << std::endl;
             return;
         }
         
         std::cout << "\n=== Información del archivo TIFF ===" << std::endl;
         std::cout << "Número total de imágenes: " << totalImages << std::endl;
-        std::cout << "Dimensiones: " << images[0].cols << "x" << images[0].rows << " píxeles" << std::endl;
-        std::cout << "Tipo de datos: " << images[0].type() << std::endl;
-        std::cout << "Canales: " << images[0].channels() << std::endl;
+        std::cout << "Dimensiones: " << volume.cols() << "x" << volume.rows() << " píxeles" << std::endl;
+        std::cout << "Tipo de datos: binario empaquetado (1 bit por píxel)" << std::endl;
+        std::cout << "Canales: 1" << std::endl;
+        std::cout << "Imágenes en memoria: " << volume.slices() << std::endl;
+        std::cout << "Memoria del volumen: " << volume.memoryBytes() / 1024.0 / 1024.0 << " MB"
+                  << " (" << (double)volume.slices() * volume.rows() * volume.cols() / 1024.0 / 1024.0
+                  << " MB como imágenes de 8 bits)" << std::endl;
+        
+        int emptySlices = 0;
+        long long occupiedTiles = 0, totalTiles = 0;
+        for (const auto& slice : occupancy) {
+            emptySlices += slice.empty ? 1 : 0;
+            occupiedTiles += slice.occupiedTiles();
+            totalTiles += (long long)slice.tileRows * slice.tileCols;
+        }
+        std::cout << "Imágenes vacías: " << emptySlices << std::endl;
+        std::cout << "Teselas con objeto: " << occupiedTiles << "/" << totalTiles
+                  << " (" << (totalTiles ? 100.0 * occupiedTiles / totalTiles : 0.0) << "%)" << std::endl;
+        
+        if (!runSlices.empty()) {
+            size_t runs = 0, bytes = 0;
+            for (const auto& slice : runSlices) {
+                runs += slice.runCount();
+                bytes += slice.memoryBytes();
+            }
+            std::cout << "Tramos RLE: " << runs << " (" << bytes / 1024.0 / 1024.0 << " MB)" << std::endl;
+        }
     }
 };
 
+static bool hasTiffExtension(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return false;
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == "tif" || ext == "tiff";
+}
+
+// Expandir las entradas del modo por lotes: un directorio aporta sus archivos
+// .tif/.tiff (en orden alfabético), un archivo TIFF se toma tal cual y cualquier
+// otro archivo se lee como una lista de rutas, una por línea
+static bool collectBatchInputs(const std::vector<std::string>& inputs, std::vector<std::string>& files) {
+    for (const auto& input : inputs) {
+        if (DIR* dir = opendir(input.c_str())) {
+            std::vector<std::string> entries;
+            while (dirent* entry = readdir(dir)) {
+                std::string name = entry->d_name;
+                if (hasTiffExtension(name)) {
+                    entries.push_back(input + (input.back() == '/' ? "" : "/") + name);
+                }
+            }
+            closedir(dir);
+            std::sort(entries.begin(), entries.end());
+            files.insert(files.end(), entries.begin(), entries.end());
+        } else if (hasTiffExtension(input)) {
+            files.push_back(input);
+        } else {
+            std::ifstream list(input);
+            if (!list.is_open()) {
+                std::cerr << "Error: No se pudo abrir la lista " << input << std::endl;
+                return false;
+            }
+            std::string line;
+            while (std::getline(list, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (!line.empty() && line[0] != '#') files.push_back(line);
+            }
+        }
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cout << "Uso: " << argv[0] << " <archivo_tiff> [método] [imagen_inicio] [imagen_fin]" << std::endl;
+    // Separar opciones (--opción) de los argumentos posicionales
+    std::vector<std::string> args;
+    bool streamMode = false;
+    bool meshMode = false;
+    bool batchMode = false;
+    bool labelMode = false;
+    bool splitLabels = false;
+    bool persistIndex = false;
+    bool binaryOutput = false;
+    bool compactOutput = false;
+    bool octreeOutput = false;
+    bool contourMode = false;
+    std::vector<std::string> convertFiles;
+    std::string cacheDir;
+    std::vector<double> tolerances;
+    PointSampling sampling;
+    std::string metricsFile;
+    size_t memoryBudget = 0;
+    int numThreads = 1;
+    std::string kernel = "bits";
+    int connectivity = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--stream") {
+            streamMode = true;
+        } else if (arg == "--mesh") {
+            meshMode = true;
+        } else if (arg == "--batch") {
+            batchMode = true;
+        } else if (arg == "--labels") {
+            labelMode = true;
+        } else if (arg == "--split-labels") {
+            labelMode = true;
+            splitLabels = true;
+        } else if (arg == "--index") {
+            persistIndex = true;
+        } else if (arg == "--binary") {
+            binaryOutput = true;
+        } else if (arg == "--compact") {
+            compactOutput = true;
+        } else if (arg == "--octree") {
+            octreeOutput = true;
+        } else if (arg == "--contours") {
+            contourMode = true;
+        } else if (arg == "--convert" && i + 2 < argc) {
+            convertFiles.assign(argv + i + 1, argv + i + 3);
+            i += 2;
+        } else if (arg == "--simplify" && i + 1 < argc) {
+            // Lista de tolerancias separadas por comas, un nivel de detalle por cada una
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                char* end = nullptr;
+                double tolerance = std::strtod(item.c_str(), &end);
+                if (item.empty() || *end != '\0' || !(tolerance >= 0)) {
+                    std::cerr << "Error: Tolerancia no válida en --simplify: " << item << std::endl;
+                    return -1;
+                }
+                tolerances.push_back(tolerance);
+            }
+        } else if (arg == "--voxel-grid" && i + 1 < argc) {
+            char* end = nullptr;
+            sampling.cellSize = std::strtod(argv[++i], &end);
+            if (*end != '\0' || !(sampling.cellSize >= 1)) {
+                std::cerr << "Error: Tamaño de celda no válido en --voxel-grid (mínimo 1): " << argv[i] << std::endl;
+                return -1;
+            }
+        } else if (arg == "--poisson" && i + 1 < argc) {
+            char* end = nullptr;
+            long long target = std::strtoll(argv[++i], &end, 10);
+            if (*end != '\0' || target < 1) {
+                std::cerr << "Error: Número de puntos no válido en --poisson: " << argv[i] << std::endl;
+                return -1;
+            }
+            sampling.targetCount = (size_t)target;
+        } else if (arg == "--seed" && i + 1 < argc) {
+            // strtoull acepta un signo y daría la vuelta con los negativos
+            char* end = nullptr;
+            errno = 0;
+            sampling.seed = std::strtoull(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || errno == ERANGE || !std::isdigit((unsigned char)argv[i][0])) {
+                std::cerr << "Error: Semilla no válida en --seed (entero sin signo): " << argv[i] << std::endl;
+                return -1;
+            }
+        } else if (arg == "--cache" && i + 1 < argc) {
+            cacheDir = argv[++i];
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metricsFile = argv[++i];
+        } else if (arg == "--memory-budget" && i + 1 < argc) {
+            if (!parseByteSize(argv[++i], memoryBudget)) {
+                std::cerr << "Error: Tamaño no válido en --memory-budget (p. ej. 512M o 2G): " << argv[i] << std::endl;
+                return -1;
+            }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            char* end = nullptr;
+            long threads = std::strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || threads < 0 || threads > INT_MAX) {
+                std::cerr << "Error: Número de hilos no válido en --threads (0 = todos los núcleos): " << argv[i] << std::endl;
+                return -1;
+            }
+            numThreads = (int)threads;
+        } else if (arg == "--kernel" && i + 1 < argc) {
+            kernel = argv[++i];
+            if (kernel != "bits" && kernel != "rle") {
+                std::cerr << "Error: Kernel no válido (use bits o rle): " << kernel << std::endl;
+                return -1;
+            }
+        } else if (arg == "--surface" && i + 1 < argc) {
+            connectivity = std::atoi(argv[++i]);
+        } else {
+            args.push_back(arg);
+        }
+    }
+    
+    // Tiempos y contadores de la ejecución (--metrics): se guardan al terminar con
+    // éxito, junto con el tamaño de los archivos generados y el pico de memoria
+    RunMetrics metrics;
+    RunMetrics* runMetrics = metricsFile.empty() ? nullptr : &metrics;
+    auto finishRun = [&](const std::vector<std::string>& files) {
+        size_t peakBytes = peakResidentBytes();
+        bool exceeded = memoryBudget > 0 && peakBytes > memoryBudget;
+        std::cout << "Memoria máxima (RSS): " << formatBytes(peakBytes) << std::endl;
+        if (exceeded) {
+            std::cout << "Presupuesto de memoria SUPERADO: pico de " << formatBytes(peakBytes) << " con un presupuesto de "
+                      << formatBytes(memoryBudget) << " (orientativo; se superó en "
+                      << formatBytes(peakBytes - memoryBudget) << ")" << std::endl;
+        } else if (memoryBudget > 0) {
+            std::cout << "Presupuesto de memoria cumplido: " << formatBytes(memoryBudget) << " (orientativo)" << std::endl;
+        }
+        if (!runMetrics) return true;
+        metrics.addCounter("peak_rss_bytes", (long long)peakBytes);
+        if (memoryBudget > 0) {
+            metrics.addCounter("memory_budget_bytes", (long long)memoryBudget);
+            metrics.setInfo("memory_budget", exceeded ? "exceeded" : "met");
+        }
+        for (const auto& file : files) {
+            std::ifstream written(file, std::ios::binary | std::ios::ate);
+            if (written.good()) metrics.addCounter("bytes_written", (long long)written.tellg());
+        }
+        if (!metrics.writeJson(metricsFile)) return false;
+        std::cout << "Métricas guardadas en: " << metricsFile << std::endl;
+        return true;
+    };
+    
+    if (!convertFiles.empty()) {
+        // Conversión entre formatos de nube de puntos (p. ej. comprimir un .xyz a .oct)
+        metrics.setInfo("mode", "convert");
+        metrics.setInfo("input", convertFiles[0]);
+        bool converted;
+        {
+            PhaseTimer timer(runMetrics, "convert");
+            converted = MultiTiffEdgeExtractor::convertPointFile(convertFiles[0], convertFiles[1], numThreads, sampling);
+        }
+        if (!converted) {
+            return -1;
+        }
+        std::cout << "Nube de puntos convertida: " << convertFiles[0] << " -> " << convertFiles[1] << std::endl;
+        return finishRun({ convertFiles[1] }) ? 0 : -1;
+    }
+    
+    if (args.empty()) {
+        std::cout << "Uso: " << argv[0] << " <archivo_tiff> [método] [imagen_inicio] [imagen_fin] [opciones]" << std::endl;
+        std::cout << "     " << argv[0] << " --batch <directorio|lista|archivo_tiff>... [método] [opciones]" << std::endl;
+        std::cout << "     " << argv[0] << " --convert <nube_entrada> <nube_salida> [--threads N] [--voxel-grid S|--poisson N]" << std::endl;
         std::cout << "Métodos disponibles:" << std::endl;
         std::cout << "  manual (por defecto) - Detección manual de bordes" << std::endl;
         std::cout << "  morphological - Detección con operadores morfológicos" << std::endl;
+        std::cout << "Opciones:" << std::endl;
+        std::cout << "  --stream - Procesar el TIFF página por página y escribir los puntos a medida que se extraen" << std::endl;
+        std::cout << "  --index - Guardar/reutilizar el índice de páginas (<archivo_tiff>.idx) para acceder a rangos" << std::endl;
+        std::cout << "  --threads N - Extraer las imágenes con N hilos (0 = todos los núcleos)" << std::endl;
+        std::cout << "  --kernel bits|rle - Kernel de bordes: palabras de 64 bits (por defecto) o tramos RLE" << std::endl;
+        std::cout << "  --batch - Procesar varias pilas en un solo proceso (un .xyz por pila y un resumen CSV)" << std::endl;
+        std::cout << "  --labels - Volumen multi-etiqueta (8/16 bits): bordes de todas las etiquetas en una pasada" << std::endl;
+        std::cout << "  --split-labels - Como --labels, y además un archivo .xyz por etiqueta" << std::endl;
+        std::cout << "  --mesh - Generar una malla de triángulos (OBJ) por marching cubes, página por página" << std::endl;
+        std::cout << "  --contours - Escribir los contornos ordenados de cada imagen (exteriores y agujeros, .ctr)" << std::endl;
+        std::cout << "  --simplify T1,T2,... - Con --contours, un nivel de detalle por tolerancia en píxeles (Douglas-Peucker)" << std::endl;
+        std::cout << "  --surface 6|18|26 - Extraer la superficie 3D (vecinos en z incluidos) con esa conectividad" << std::endl;
+        std::cout << "  --binary - Guardar además la nube en PLY y PCD binarios (float little-endian)" << std::endl;
+        std::cout << "  --compact - Escribir los puntos en formato compacto (.edg, diferencias + varint) en lugar de XYZ" << std::endl;
+        std::cout << "  --octree - Guardar además la nube comprimida con un octree de ocupación (.oct)" << std::endl;
+        std::cout << "  --voxel-grid S - Submuestrear la nube dejando un punto por celda de S vóxeles de lado" << std::endl;
+        std::cout << "  --poisson N - Submuestrear la nube con ruido azul (Poisson-disk) a N puntos" << std::endl;
+        std::cout << "  --seed N - Semilla del submuestreo (mismo resultado con la misma semilla)" << std::endl;
+        std::cout << "  --cache DIR - Reutilizar los puntos de las imágenes que no cambiaron desde la última ejecución" << std::endl;
+        std::cout << "  --metrics M.json - Guardar tiempos por fase y contadores de la ejecución en JSON" << std::endl;
+        std::cout << "  --memory-budget B - Presupuesto de memoria orientativo (p. ej. 512M): streaming o bloques de imágenes si la pila no cabe" << std::endl;
+        std::cout << "  --convert E S - Convertir la nube E a S según la extensión (.oct, .edg, .ply, .pcd, .xyz)" << std::endl;
         std::cout << "Ejemplos:" << std::endl;
         std::cout << "  " << argv[0] << " stack.tiff" << std::endl;
         std::cout << "  " << argv[0] << " stack.tiff morphological" << std::endl;
         std::cout << "  " << argv[0] << " stack.tiff manual 0 50" << std::endl;
+        std::cout << "  " << argv[0] << " stack.tiff manual --stream" << std::endl;
+        std::cout << "  " << argv[0] << " stack.tiff morphological --threads 8" << std::endl;
+        std::cout << "  " << argv[0] << " stack.tiff manual --surface 26 --stream" << std::endl;
+        std::cout << "  " << argv[0] << " stack.tiff manual --binary" << std::endl;
+        std::cout << "  " << argv[0] << " stack.tiff manual --stream --compact" << std::endl;
+        std::cout << "  " << argv[0] << " stack.tiff manual --cache output/cache" << std::endl;
+        std::cout << "  " << argv[0] << " stack.tiff manual --poisson 200000 --seed 7" << std::endl;
+        std::cout << "  " << argv[0] << " stack.tiff manual --threads 0 --metrics output/metrics.json" << std::endl;
+        std::cout << "  " << argv[0] << " stack.tiff manual --binary --memory-budget 256M" << std::endl;
+        std::cout << "  " << argv[0] << " --convert output/stack_3D_edges_manual.xyz output/stack_3D_edges_manual.oct" << std::endl;
+        std::cout << "  " << argv[0] << " stack.tiff --mesh" << std::endl;
+        std::cout << "  " << argv[0] << " stack.tiff --contours" << std::endl;
+        std::cout << "  " << argv[0] << " stack.tiff --contours --simplify 0,1,2.5" << std::endl;
+        std::cout << "  " << argv[0] << " --batch imagenT manual --threads 0" << std::endl;
+        std::cout << "  " << argv[0] << " etiquetas.tiff manual --labels" << std::endl;
         return -1;
     }
     
-    std::string inputFile = argv[1];
-    std::string method = (argc >= 3) ? argv[2] : "manual";
-    
-    MultiTiffEdgeExtractor extractor;
-    
-    // Cargar archivo TIFF multi-imagen
-    if (!extractor.loadMultiTiffImage(inputFile)) {
+    if (connectivity != 0 && connectivity != 6 && connectivity != 18 && connectivity != 26) {
+        std::cerr << "Error: Conectividad no válida (use 6, 18 o 26): " << connectivity << std::endl;
         return -1;
     }
     
-    // Mostrar información del archivo
-    extractor.printTiffInfo();
+    if ((binaryOutput || octreeOutput) && (streamMode || meshMode || batchMode || labelMode)) {
+        // La cabecera binaria lleva el número de puntos y el octree necesita todos los
+        // puntos: hace falta la nube completa en memoria
+        std::cerr << "Error: --binary y --octree solo están disponibles sin --stream, --mesh, --batch ni --labels" << std::endl;
+        return -1;
+    }
+    if (compactOutput && (meshMode || batchMode || labelMode)) {
+        std::cerr << "Error: --compact solo está disponible sin --mesh, --batch ni --labels" << std::endl;
+        return -1;
+    }
+    if (contourMode && (streamMode || meshMode || batchMode || labelMode || binaryOutput || compactOutput ||
+                        octreeOutput || connectivity != 0 || !cacheDir.empty())) {
+        std::cerr << "Error: --contours no se combina con otros modos ni formatos de salida" << std::endl;
+        return -1;
+    }
+    if (!tolerances.empty() && !contourMode) {
+        std::cerr << "Error: --simplify solo está disponible con --contours" << std::endl;
+        return -1;
+    }
+    if (sampling.cellSize > 0 && sampling.targetCount > 0) {
+        std::cerr << "Error: Use solo uno de --voxel-grid y --poisson" << std::endl;
+        return -1;
+    }
+    if (sampling.enabled() && (streamMode || meshMode || batchMode || labelMode || contourMode)) {
+        // El submuestreo trabaja sobre la nube completa en memoria
+        std::cerr << "Error: --voxel-grid y --poisson solo están disponibles sin --stream, --mesh, --batch, --labels ni --contours" << std::endl;
+        return -1;
+    }
+    if (!cacheDir.empty() && (streamMode || meshMode || batchMode || labelMode)) {
+        // La clave de cada imagen se calcula sobre el volumen cargado
+        std::cerr << "Error: --cache solo está disponible sin --stream, --mesh, --batch ni --labels" << std::endl;
+        return -1;
+    }
+    if (memoryBudget > 0 && batchMode) {
+        std::cerr << "Error: --memory-budget no está disponible con --batch" << std::endl;
+        return -1;
+    }
     
-    // Extraer puntos de borde según los parámetros
-    if (argc >= 5) {
-        // Rango específico de imágenes
-        int startImg = std::atoi(argv[3]);
-        int endImg = std::atoi(argv[4]);
-        bool useMorphological = (method == "morphological");
-        extractor.extractEdgePointsRange(startImg, endImg, useMorphological);
-    } else {
-        // Todas las imágenes
-        if (method == "morphological") {
-            extractor.extractEdgePointsMorphological();
-        } else {
-            extractor.extractEdgePointsManual();
+    if (batchMode) {
+        // Las entradas son todos los argumentos posicionales salvo el método
+        std::string method = "manual";
+        std::vector<std::string> inputs, files, outputs;
+        for (const auto& arg : args) {
+            if (arg == "manual" || arg == "morphological") {
+                method = arg;
+            } else {
+                inputs.push_back(arg);
+            }
+        }
+        if (!collectBatchInputs(inputs, files)) {
+            return -1;
+        }
+        if (files.empty()) {
+            std::cerr << "Error: No se encontraron archivos TIFF para el lote" << std::endl;
+            return -1;
+        }
+        
+        std::string edgeKind = connectivity ? "_3D_surface" + std::to_string(connectivity) + "_" : "_3D_edges_";
+        for (const auto& file : files) {
+            outputs.push_back("output/" + file.substr(0, file.find_last_of('.')) + edgeKind + method + ".xyz");
         }
+        
+        std::cout << "Procesando lote de " << files.size() << " pilas" << std::endl;
+        metrics.setInfo("mode", "batch");
+        metrics.setInfo("method", method);
+        metrics.setInfo("threads", std::to_string(numThreads));
+        metrics.setInfo("kernel", kernel);
+        metrics.setInfo("surface", std::to_string(connectivity));
+        bool ok = MultiTiffEdgeExtractor::runBatch(files, outputs, method == "morphological", numThreads,
+                                                   kernel == "rle", connectivity, "output/batch_summary.csv",
+                                                   runMetrics);
+        outputs.push_back("output/batch_summary.csv");
+        return ok && finishRun(outputs) ? 0 : -1;
     }
     
-    // Mostrar estadísticas
-    extractor.printStatistics();
+    std::string inputFile = args[0];
+    std::string method = (args.size() >= 2) ? args[1] : "manual";
+    bool useMorphological = (method == "morphological");
+    bool hasRange = (args.size() >= 4);
+    int startImg = hasRange ? std::atoi(args[2].c_str()) : 0;
+    int endImg = hasRange ? std::atoi(args[3].c_str()) : INT_MAX;
     
     // Generar nombres de archivo de salida
     std::string baseName = inputFile.substr(0, inputFile.find_last_of('.'));
-    //std::string plyFile = "output/" + baseName + "_3D_edges.ply";
-    std::string xyzFile = "output/" + baseName + "_3D_edges_" + method + ".xyz";
-    //std::string pcdFile = "output/" + baseName + "_3D_edges.pcd";
+    std::string edgeKind = connectivity ? "_3D_surface" + std::to_string(connectivity) + "_" : "_3D_edges_";
+    std::string plyFile = "output/" + baseName + edgeKind + method + ".ply";
+    std::string pointFile = "output/" + baseName + edgeKind + method + (compactOutput ? ".edg" : ".xyz");
+    std::string pcdFile = "output/" + baseName + edgeKind + method + ".pcd";
+    std::string octFile = "output/" + baseName + edgeKind + method + ".oct";
+    std::string objFile = "output/" + baseName + "_mesh.obj";
+    std::string contourFile = "output/" + baseName + "_contours.ctr";
+    
+    MultiTiffEdgeExtractor extractor;
+    extractor.setPersistPageIndex(persistIndex);
+    extractor.setNumThreads(numThreads);
+    extractor.setRunLengthKernel(kernel == "rle");
+    extractor.setSurfaceConnectivity(connectivity);
+    extractor.setCompactOutput(compactOutput);
+    extractor.setMetrics(runMetrics);
+    if (!cacheDir.empty() && !extractor.setSliceCache(cacheDir)) {
+        return -1;
+    }
+    
+    // Memoria de la ejecución, estimada antes de cargar con la cabecera y, solo con
+    // presupuesto, con los puntos de unas imágenes de muestra, que cuesta
+    // decodificarlas. Con --memory-budget (orientativo), si la carga completa
+    // no cabe se pasa a streaming (una página a la vez) o, si hace falta la nube en
+    // memoria o el volumen (binarios, octree, submuestreo, caché), a bloques de
+    // imágenes; si ni el mínimo de esas estrategias cabe, no se procesa. Los modos
+    // de etiquetas, contornos y malla ya procesan página por página.
+    int chunkPages = 0;
+    size_t expectedPoints = 0;
+    size_t writerChunk = memoryBudget > 0 ? BUDGET_WRITER_CHUNK : 1 << 20;
+    size_t writerQueue = memoryBudget > 0 ? BUDGET_WRITER_QUEUE : 4;
+    if (!labelMode && !contourMode && !meshMode) {
+        MemoryEstimate estimate;
+        int threads = extractor.threadCount();
+        bool keepCloud = binaryOutput || octreeOutput || sampling.enabled();
+        if (extractor.estimateLoadMemory(inputFile, useMorphological, startImg, endImg, memoryBudget > 0, estimate)) {
+            // Búferes del XYZ y la nube en memoria, con un margen para el error de la
+            // muestra y lo que piden el octree y el submuestreo
+            expectedPoints = estimate.points + estimate.points / 8;
+            size_t pointBytes = sizeof(LatticePoint) + (octreeOutput ? OCTREE_BYTES_PER_POINT : 0) +
+                                (sampling.enabled() ? SAMPLING_BYTES_PER_POINT : 0);
+            size_t outputBytes = writerBytes(writerChunk, writerQueue) + (keepCloud ? expectedPoints * pointBytes : 0);
+            size_t fullBytes = estimate.total(threads) + outputBytes;
+            size_t streamBytes = estimate.streamBytes(threads, sizeof(LatticePoint)) + writerBytes(writerChunk, writerQueue);
+            // Sin presupuesto no se cuentan los puntos: solo la pila según la cabecera
+            if (memoryBudget == 0) fullBytes = estimate.total(threads);
+            if (!streamMode) {
+                std::cout << "Memoria estimada: " << formatBytes(fullBytes) << " (" << estimate.pages
+                          << " imágenes de " << estimate.cols << "x" << estimate.rows;
+                if (memoryBudget > 0) {
+                    std::cout << ", unos " << estimate.points << " puntos)" << std::endl;
+                } else {
+                    std::cout << ", sin contar la nube de puntos)" << std::endl;
+                }
+            }
+            metrics.addCounter("memory_estimate_bytes", (long long)(streamMode ? streamBytes : fullBytes));
+            
+            if (memoryBudget > 0) {
+                size_t baseline = currentResidentBytes();
+                size_t available = memoryBudget > baseline ? memoryBudget - baseline : 0;
+                size_t margin = connectivity ? 2 : 0;
+                size_t chunkFixed = estimate.pageBytes * threads + outputBytes;
+                size_t chunkMinimum = chunkFixed + (margin + 1) * estimate.sliceBytes;
+                bool canStream = streamMode || (!keepCloud && cacheDir.empty());
+                if (streamMode ? streamBytes <= available : fullBytes <= available) {
+                    // La pila cabe: se procesa como se pidió
+                } else if (canStream && streamBytes <= available) {
+                    std::cout << "La pila no cabe en el presupuesto de " << formatBytes(memoryBudget)
+                              << ": se procesa en modo streaming" << std::endl;
+                    streamMode = true;
+                } else if (!streamMode && chunkMinimum <= available) {
+                    chunkPages = (int)std::min<size_t>((available - chunkFixed) / estimate.sliceBytes - margin,
+                                                       estimate.pages);
+                    std::cout << "La pila no cabe en el presupuesto de " << formatBytes(memoryBudget)
+                              << ": se procesa por bloques de " << chunkPages << " imágenes" << std::endl;
+                } else {
+                    size_t minimum = baseline + (streamMode ? streamBytes
+                                                 : canStream ? std::min(streamBytes, chunkMinimum) : chunkMinimum);
+                    std::cerr << "Error: El presupuesto de memoria (" << formatBytes(memoryBudget)
+                              << ") es menor que el mínimo estimado para esta ejecución (" << formatBytes(minimum)
+                              << ", de los que " << formatBytes(baseline) << " ya usa el proceso)" << std::endl;
+                    return -1;
+                }
+            }
+        } else if (memoryBudget > 0) {
+            std::cerr << "Aviso: No se pudo estimar la memoria de " << inputFile
+                      << " (formato no soportado por el lector por páginas); se ignora --memory-budget" << std::endl;
+            memoryBudget = 0;
+        }
+    }
+    
+    std::string mode = labelMode ? "labels" : contourMode ? "contours" : meshMode ? "mesh" : streamMode ? "stream" : chunkPages ? "chunked" : "memory";
+    metrics.setInfo("mode", mode);
+    metrics.setInfo("input", inputFile);
+    metrics.setInfo("method", method);
+    metrics.setInfo("threads", std::to_string(numThreads));
+    metrics.setInfo("kernel", kernel);
+    metrics.setInfo("surface", std::to_string(connectivity));
+    {
+        std::ifstream input(inputFile, std::ios::binary | std::ios::ate);
+        if (input.good()) metrics.addCounter("input_bytes", (long long)input.tellg());
+    }
+    
+    if (labelMode) {
+        // Volumen multi-etiqueta: un único flujo de puntos etiquetados (x y z etiqueta)
+        std::string labelFile = "output/" + baseName + "_3D_labels_" + method + ".xyz";
+        AsyncFileWriter labelOut(labelFile);
+        if (!labelOut.is_open()) {
+            std::cerr << "Error: No se pudo crear el archivo " << labelFile << std::endl;
+            return -1;
+        }
+        if (!extractor.extractLabelEdgesStreaming(inputFile, useMorphological, startImg, endImg, &labelOut,
+                                                  splitLabels)) {
+            return -1;
+        }
+        if (!labelOut.close()) {
+            std::cerr << "Error: No se pudo escribir el archivo " << labelFile << std::endl;
+            return -1;
+        }
+        std::cout << "Puntos etiquetados guardados en: " << labelFile << std::endl;
+        
+        if (splitLabels && !extractor.saveLabelFiles("output/" + baseName, "_3D_edges_" + method + ".xyz")) {
+            return -1;
+        }
+        extractor.printStatistics();
+        
+        std::cout << "\nProcesamiento completado exitosamente!" << std::endl;
+        std::cout << "Archivos generados:" << std::endl;
+        std::cout << "  - " << labelFile << " (formato XYZ con etiqueta)" << std::endl;
+        metrics.addCounter("points", (long long)extractor.pointCount());
+        return finishRun({ labelFile }) ? 0 : -1;
+    }
     
-    // Guardar resultados
-    //extractor.savePointCloudPLY(plyFile);
-    extractor.savePointCloudXYZ(xyzFile);
-    //extractor.savePointCloudPCD(pcdFile);
+    if (contourMode) {
+        // Contornos ordenados por imagen: se escriben mientras se decodifican las páginas
+        AsyncFileWriter contourOut(contourFile);
+        if (!contourOut.is_open()) {
+            std::cerr << "Error: No se pudo crear el archivo " << contourFile << std::endl;
+            return -1;
+        }
+        if (!extractor.extractContoursStreaming(inputFile, startImg, endImg, tolerances, contourOut)) {
+            return -1;
+        }
+        if (!contourOut.close()) {
+            std::cerr << "Error: No se pudo escribir el archivo " << contourFile << std::endl;
+            return -1;
+        }
+        std::cout << "Contornos guardados en: " << contourFile << std::endl;
+        
+        std::cout << "\nProcesamiento completado exitosamente!" << std::endl;
+        std::cout << "Archivos generados:" << std::endl;
+        std::cout << "  - " << contourFile << " (contornos por imagen)" << std::endl;
+        return finishRun({ contourFile }) ? 0 : -1;
+    }
     
-    // Guardar algunas imágenes de bordes para verificación
-    extractor.saveEdgeImages(baseName, 0);
+    if (meshMode) {
+        // Malla por marching cubes: se escribe mientras se decodifican las páginas
+        AsyncFileWriter objOut(objFile);
+        if (!objOut.is_open()) {
+            std::cerr << "Error: No se pudo crear el archivo " << objFile << std::endl;
+            return -1;
+        }
+        if (!extractor.extractMeshStreaming(inputFile, startImg, endImg, objOut)) {
+            return -1;
+        }
+        if (!objOut.close()) {
+            std::cerr << "Error: No se pudo escribir el archivo " << objFile << std::endl;
+            return -1;
+        }
+        std::cout << "Malla guardada en: " << objFile << std::endl;
+        
+        std::cout << "\nProcesamiento completado exitosamente!" << std::endl;
+        std::cout << "Archivos generados:" << std::endl;
+        std::cout << "  - " << objFile << " (formato OBJ)" << std::endl;
+        return finishRun({ objFile }) ? 0 : -1;
+    } else if (streamMode) {
+        // Modo streaming: los puntos se escriben mientras se decodifican las páginas
+        AsyncFileWriter pointOut(pointFile, writerChunk, writerQueue);
+        if (!pointOut.is_open()) {
+            std::cerr << "Error: No se pudo crear el archivo " << pointFile << std::endl;
+            return -1;
+        }
+        if (!extractor.extractEdgePointsStreaming(inputFile, useMorphological, startImg, endImg, &pointOut)) {
+            return -1;
+        }
+        {
+            PhaseTimer timer(runMetrics, "write");
+            if (!extractor.finishPointOutput(pointOut) || !pointOut.close()) {
+                std::cerr << "Error: No se pudo escribir el archivo " << pointFile << std::endl;
+                return -1;
+            }
+        }
+        std::cout << "Nube de puntos guardada en: " << pointFile << std::endl;
+        
+        extractor.printStatistics();
+    } else {
+        // Cargar archivo TIFF multi-imagen (solo las páginas del rango si se indicó uno);
+        // por bloques cada uno se carga durante la extracción
+        if (!chunkPages) {
+            bool loaded;
+            {
+                PhaseTimer timer(runMetrics, "load");
+                loaded = hasRange ? extractor.loadMultiTiffRange(inputFile, startImg, endImg)
+                                  : extractor.loadMultiTiffImage(inputFile);
+            }
+            if (!loaded) {
+                return -1;
+            }
+            
+            // Mostrar información del archivo
+            extractor.printTiffInfo();
+        }
+        
+        // Los puntos se escriben en el XYZ mientras se extraen; un hilo escritor
+        // vacía la cola de bloques en disco en paralelo con la extracción. Con
+        // --binary u --octree la nube se queda en memoria para escribir también
+        // PLY y PCD o el octree, y con submuestreo para reducirla antes de guardarla.
+        std::unique_ptr<AsyncFileWriter> pointOut;
+        if (!binaryOutput && !octreeOutput && !sampling.enabled()) {
+            pointOut.reset(new AsyncFileWriter(pointFile, writerChunk, writerQueue));
+            if (!pointOut->is_open()) {
+                std::cerr << "Error: No se pudo crear el archivo " << pointFile << std::endl;
+                return -1;
+            }
+            extractor.setPointSink(pointOut.get());
+        }
+        
+        // Extraer puntos de borde según los parámetros
+        if (chunkPages) {
+            if (!extractor.extractEdgePointsChunked(inputFile, useMorphological, startImg, endImg, chunkPages,
+                                                    expectedPoints)) {
+                return -1;
+            }
+        } else if (hasRange) {
+            // Rango específico de imágenes
+            extractor.extractEdgePointsRange(startImg, endImg, useMorphological);
+        } else {
+            // Todas las imágenes
+            if (useMorphological) {
+                extractor.extractEdgePointsMorphological();
+            } else {
+                extractor.extractEdgePointsManual();
+            }
+        }
+        
+        extractor.setPointSink(nullptr);
+        extractor.subsamplePoints(sampling);
+        {
+            // Con el XYZ escrito durante la extracción solo queda vaciar la cola
+            PhaseTimer timer(runMetrics, "write");
+            if (pointOut) {
+                if (!extractor.finishPointOutput(*pointOut) || !pointOut->close()) {
+                    std::cerr << "Error: No se pudo escribir el archivo " << pointFile << std::endl;
+                    return -1;
+                }
+            } else if (compactOutput ? !extractor.savePointCloudCompact(pointFile) : !extractor.savePointCloudXYZ(pointFile)) {
+                return -1;
+            }
+        }
+        std::cout << "Nube de puntos guardada en: " << pointFile << std::endl;
+        
+        // Mostrar estadísticas
+        extractor.printStatistics();
+        
+        // Guardar resultados binarios (necesitan la nube en memoria)
+        {
+            PhaseTimer timer(binaryOutput ? runMetrics : nullptr, "write_binary");
+            if (binaryOutput && (!extractor.savePointCloudPLY(plyFile, true) ||
+                                 !extractor.savePointCloudPCD(pcdFile, true))) {
+                return -1;
+            }
+        }
+        {
+            PhaseTimer timer(octreeOutput ? runMetrics : nullptr, "write_octree");
+            if (octreeOutput && !extractor.savePointCloudOctree(octFile)) {
+                return -1;
+            }
+        }
+        
+        // Guardar algunas imágenes de bordes para verificación
+        extractor.saveEdgeImages(baseName, 0);
+    }
     
     std::cout << "\nProcesamiento completado exitosamente!" << std::endl;
     std::cout << "Archivos generados:" << std::endl;
-    //std::cout << "  - " << plyFile << " (formato PLY)" << std::endl;
-    std::cout << "  - " << xyzFile << " (formato XYZ)" << std::endl;
-    //std::cout << "  - " << pcdFile << " (formato PCD)" << std::endl;
+    std::cout << "  - " << pointFile << (compactOutput ? " (formato compacto)" : " (formato XYZ)") << std::endl;
+    if (binaryOutput) {
+        std::cout << "  - " << plyFile << " (formato PLY binario)" << std::endl;
+        std::cout << "  - " << pcdFile << " (formato PCD binario)" << std::endl;
+    }
+    if (octreeOutput) {
+        std::cout << "  - " << octFile << " (octree comprimido)" << std::endl;
+    }
     
-    return 0;
-}
\ No newline at end of file
+    metrics.addCounter("points", (long long)extractor.pointCount());
+    std::vector<std::string> written = { pointFile };
+    if (binaryOutput) {
+        written.push_back(plyFile);
+        written.push_back(pcdFile);
+    }
+    if (octreeOutput) written.push_back(octFile);
+    return finishRun(written) ? 0 : -1;
+}
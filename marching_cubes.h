@@ -0,0 +1,355 @@
+#ifndef MARCHING_CUBES_H
+#define MARCHING_CUBES_H
+
+#include <vector>
+#include <cstdint>
+#include <ostream>
+#include <algorithm>
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include "bit_volume.h"
+#include "ascii_writer.h"
+
+// Tabla de marching cubes para volúmenes binarios. Las esquinas de una celda se
+// numeran con bits: bit 0 = columna + 1, bit 1 = fila + 1, bit 2 = imagen + 1.
+// Las aristas se numeran eje * 4 + k, donde k recorre las 4 esquinas sin el bit
+// del eje. En lugar de copiar la tabla clásica de 256 casos se construye a partir
+// de las caras: en cada cara se corta cada tramo de esquinas de objeto con un
+// segmento (en las caras ambiguas las esquinas de objeto quedan separadas), los
+// segmentos de las 6 caras se encadenan en lazos y cada lazo se triangula en
+// abanico. Como la regla de cada cara solo depende de sus 4 esquinas, dos celdas
+// vecinas siempre coinciden y la malla resultante es cerrada. Si ningún vértice
+// del lazo sirve como origen del abanico sin trazar una diagonal sobre una cara
+// (la celda vecina podría trazar la misma), el lazo se triangula desde un vértice
+// central propio de la celda, indicado en la tabla como CENTER + número de lazo.
+class MarchingCubesTable {
+public:
+    static const int CENTER = 12;
+
+private:
+    std::vector<int> triangles[256];  // Tríos de aristas por configuración
+    std::vector<std::vector<int>> centerLoops[256]; // Lazos con vértice central
+    int cornerOfEdge[12];
+    int axisOfEdge[12];
+    int facesOfEdge[12];              // Máscara de las 2 caras que contienen cada arista
+
+    int edgeBetween(int a, int b) const {
+        int axis = (a ^ b) == 1 ? 0 : ((a ^ b) == 2 ? 1 : 2);
+        int corner = std::min(a, b);
+        for (int e = axis * 4; e < axis * 4 + 4; e++) {
+            if (cornerOfEdge[e] == corner) return e;
+        }
+        return -1;
+    }
+
+    void build() {
+        for (int axis = 0, e = 0; axis < 3; axis++) {
+            for (int corner = 0; corner < 8; corner++) {
+                if (corner & (1 << axis)) continue;
+                cornerOfEdge[e] = corner;
+                axisOfEdge[e] = axis;
+                e++;
+            }
+        }
+
+        // Esquinas de cada cara en sentido antihorario visto desde fuera de la celda
+        static const int FACES[6][4] = {
+            {0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6}
+        };
+
+        for (int e = 0; e < 12; e++) {
+            facesOfEdge[e] = 0;
+            int other = cornerOfEdge[e] | (1 << axisOfEdge[e]);
+            for (int f = 0; f < 6; f++) {
+                bool hasA = false, hasB = false;
+                for (int k = 0; k < 4; k++) {
+                    hasA = hasA || FACES[f][k] == cornerOfEdge[e];
+                    hasB = hasB || FACES[f][k] == other;
+                }
+                if (hasA && hasB) facesOfEdge[e] |= 1 << f;
+            }
+        }
+
+        for (int config = 0; config < 256; config++) {
+            int next[12];
+            std::fill(next, next + 12, -1);
+
+            for (const auto& face : FACES) {
+                bool inside[4];
+                for (int k = 0; k < 4; k++) inside[k] = (config >> face[k]) & 1;
+
+                // Cada tramo de esquinas de objeto del ciclo genera un segmento desde
+                // la arista por la que sale del tramo hasta la arista por la que entra
+                for (int k = 0; k < 4; k++) {
+                    int before = (k + 3) % 4;
+                    if (!inside[k] || inside[before]) continue;
+                    int j = k;
+                    while (inside[(j + 1) % 4]) j = (j + 1) % 4;
+                    int entering = edgeBetween(face[before], face[k]);
+                    int leaving = edgeBetween(face[j], face[(j + 1) % 4]);
+                    next[leaving] = entering;
+                }
+            }
+
+            // Encadenar los segmentos en lazos y triangular cada lazo en abanico
+            bool used[12] = {false};
+            for (int start = 0; start < 12; start++) {
+                if (next[start] < 0 || used[start]) continue;
+                std::vector<int> loop;
+                for (int e = start; !used[e]; e = next[e]) {
+                    used[e] = true;
+                    loop.push_back(e);
+                }
+                const size_t n = loop.size();
+
+                // Origen del abanico cuyas diagonales no estén sobre ninguna cara
+                int origin = -1;
+                for (size_t o = 0; o < n && origin < 0; o++) {
+                    bool valid = true;
+                    for (size_t i = 2; i + 1 < n; i++) {
+                        if (facesOfEdge[loop[o]] & facesOfEdge[loop[(o + i) % n]]) valid = false;
+                    }
+                    if (valid) origin = (int)o;
+                }
+
+                if (origin >= 0) {
+                    for (size_t i = 1; i + 1 < n; i++) {
+                        triangles[config].push_back(loop[origin]);
+                        triangles[config].push_back(loop[(origin + i) % n]);
+                        triangles[config].push_back(loop[(origin + i + 1) % n]);
+                    }
+                } else {
+                    int center = CENTER + (int)centerLoops[config].size();
+                    centerLoops[config].push_back(loop);
+                    for (size_t i = 0; i < n; i++) {
+                        triangles[config].push_back(center);
+                        triangles[config].push_back(loop[i]);
+                        triangles[config].push_back(loop[(i + 1) % n]);
+                    }
+                }
+            }
+        }
+    }
+
+public:
+    MarchingCubesTable() {
+        build();
+    }
+
+    static const MarchingCubesTable& instance() {
+        static const MarchingCubesTable table;
+        return table;
+    }
+
+    const std::vector<int>& cellTriangles(int config) const { return triangles[config]; }
+    const std::vector<int>& centerLoop(int config, int center) const { return centerLoops[config][center - CENTER]; }
+    int edgeCorner(int edge) const { return cornerOfEdge[edge]; }
+    int edgeAxis(int edge) const { return axisOfEdge[edge]; }
+};
+
+// Mallador por marching cubes que recibe las imágenes en orden y escribe la malla
+// en formato OBJ a medida que avanza: cada par de imágenes consecutivas forma una
+// capa de celdas, y los vértices (puntos medios de las aristas de la rejilla) se
+// comparten entre celdas vecinas y entre capas. Solo se guardan dos imágenes
+// empaquetadas y los índices de vértice de las aristas de dos planos. Fuera del
+// volumen se asume fondo, así que la superficie queda cerrada.
+class StreamingMesher {
+private:
+    std::unique_ptr<AsciiWriter> out;
+    BitVolume planes;                   // Imagen anterior y actual (ventana de dos)
+    int numRows = 0;
+    int numCols = 0;
+    int slicesAdded = 0;
+    int firstIndex = 0;                 // Coordenada z de la primera imagen
+    long long vertexCount = 0;
+    long long triangleCount = 0;
+
+    // Índices de vértice (1-based, 0 = sin crear) de las aristas en x e y de los
+    // dos planos de la capa y de las aristas en z entre ellos. Los puntos de la
+    // rejilla incluyen un margen de fondo: columnas [-1, cols] y filas [-1, rows].
+    std::vector<long long> planeEdges[2][2];
+    std::vector<long long> zEdges;
+    std::vector<uint64_t> zeroRow, anyRow, allRow, mixedCells;
+
+    size_t latticeIndex(int col, int row) const {
+        return (size_t)(row + 1) * (numCols + 2) + (col + 1);
+    }
+
+    static int voxel(const uint64_t* row, int col, int cols) {
+        if (!row || col < 0 || col >= cols) return 0;
+        return (row[col >> 6] >> (col & 63)) & 1;
+    }
+
+    // Punto medio de la arista 'edge' de la celda (col, row, zLower), en coordenadas
+    // del mundo como en la nube de puntos (Y invertida)
+    cv::Point3d edgePoint(const MarchingCubesTable& table, int edge, int col, int row, int zLower) const {
+        int corner = table.edgeCorner(edge);
+        int axis = table.edgeAxis(edge);
+        return cv::Point3d(col + (corner & 1) + (axis == 0 ? 0.5 : 0.0),
+                       numRows - row - ((corner >> 1) & 1) - (axis == 1 ? 0.5 : 0.0),
+                       zLower + (corner >> 2) + (axis == 2 ? 0.5 : 0.0));
+    }
+
+    long long writeVertex(const cv::Point3d& p) {
+        out->text("v ");
+        out->number(p.x);
+        out->put(' ');
+        out->number(p.y);
+        out->put(' ');
+        out->number(p.z);
+        out->put('\n');
+        return ++vertexCount;
+    }
+
+    // Índice del vértice de una arista de la celda, escribiéndolo si es nuevo
+    long long edgeVertex(const MarchingCubesTable& table, int edge, int col, int row, int zLower) {
+        int corner = table.edgeCorner(edge);
+        int axis = table.edgeAxis(edge);
+        size_t index = latticeIndex(col + (corner & 1), row + ((corner >> 1) & 1));
+        long long& slot = (axis == 2) ? zEdges[index] : planeEdges[(zLower + (corner >> 2) + 1) & 1][axis][index];
+        if (slot == 0) {
+            slot = writeVertex(edgePoint(table, edge, col, row, zLower));
+        }
+        return slot;
+    }
+
+    // Mallar la capa de celdas entre las imágenes zLower y zLower + 1
+    // (nullptr = imagen fuera del volumen)
+    void processLayer(const BitSliceView* lower, const BitSliceView* upper, int zLower) {
+        const MarchingCubesTable& table = MarchingCubesTable::instance();
+        const int words = packedWords(numCols);
+        const int cellWords = packedWords(numCols + 1);
+
+        // El plano superior es nuevo: sus aristas aún no tienen vértices
+        for (int axis = 0; axis < 2; axis++) {
+            std::vector<long long>& edges = planeEdges[(zLower + 2) & 1][axis];
+            std::fill(edges.begin(), edges.end(), 0);
+        }
+        std::fill(zEdges.begin(), zEdges.end(), 0);
+
+        for (int row = -1; row < numRows; row++) {
+            const uint64_t* rows[2][2];
+            const BitSliceView* planeViews[2] = { lower, upper };
+            for (int p = 0; p < 2; p++) {
+                for (int dy = 0; dy < 2; dy++) {
+                    int r = row + dy;
+                    bool inside = planeViews[p] && r >= 0 && r < numRows;
+                    rows[p][dy] = inside ? planeViews[p]->row(r) : zeroRow.data();
+                }
+            }
+
+            // Celdas mixtas (alguna esquina de objeto y alguna de fondo): el bit c
+            // corresponde a la celda entre las columnas c - 1 y c
+            for (int w = 0; w < words; w++) {
+                anyRow[w] = rows[0][0][w] | rows[0][1][w] | rows[1][0][w] | rows[1][1][w];
+                allRow[w] = rows[0][0][w] & rows[0][1][w] & rows[1][0][w] & rows[1][1][w];
+            }
+            bool hasCells = false;
+            for (int w = 0; w < cellWords; w++) {
+                uint64_t any = anyRow[w], all = allRow[w];
+                uint64_t anyLeft = (any << 1) | (w > 0 ? anyRow[w - 1] >> 63 : 0);
+                uint64_t allLeft = (all << 1) | (w > 0 ? allRow[w - 1] >> 63 : 0);
+                mixedCells[w] = (any | anyLeft) & ~(all & allLeft);
+                hasCells = hasCells || mixedCells[w];
+            }
+            if (!hasCells) continue;
+
+            forEachSetBit(mixedCells.data(), cellWords, [&](int cell) {
+                int col = cell - 1;
+                int config = 0;
+                for (int corner = 0; corner < 8; corner++) {
+                    config |= voxel(rows[corner >> 2][(corner >> 1) & 1], col + (corner & 1), numCols) << corner;
+                }
+
+                const std::vector<int>& tris = table.cellTriangles(config);
+                long long centers[4] = {0, 0, 0, 0};
+                for (size_t t = 0; t < tris.size(); t += 3) {
+                    long long ids[3];
+                    for (int k = 0; k < 3; k++) {
+                        int edge = tris[t + k];
+                        if (edge < MarchingCubesTable::CENTER) {
+                            ids[k] = edgeVertex(table, edge, col, row, zLower);
+                            continue;
+                        }
+                        // Vértice central del lazo: promedio de sus puntos, propio de la celda
+                        long long& center = centers[edge - MarchingCubesTable::CENTER];
+                        if (center == 0) {
+                            const std::vector<int>& loop = table.centerLoop(config, edge);
+                            cv::Point3d sum(0, 0, 0);
+                            for (int loopEdge : loop) sum += edgePoint(table, loopEdge, col, row, zLower);
+                            center = writeVertex(sum * (1.0 / loop.size()));
+                        }
+                        ids[k] = center;
+                    }
+                    // Normales hacia el fondo (orientación ya corregida por la Y invertida)
+                    out->text("f ");
+                    out->integer(ids[0]);
+                    out->put(' ');
+                    out->integer(ids[1]);
+                    out->put(' ');
+                    out->integer(ids[2]);
+                    out->put('\n');
+                    triangleCount++;
+                }
+            });
+        }
+    }
+
+public:
+    // Empezar una malla de imágenes rows x cols; la primera imagen tiene z = 'firstZ'
+    void begin(std::ostream& stream, int rows, int cols, int firstZ) {
+        out.reset(new AsciiWriter(stream));
+        numRows = rows;
+        numCols = cols;
+        firstIndex = firstZ;
+        slicesAdded = 0;
+        vertexCount = triangleCount = 0;
+        planes.create(2, rows, cols);
+
+        size_t lattice = (size_t)(rows + 2) * (cols + 2);
+        for (int p = 0; p < 2; p++) {
+            for (int axis = 0; axis < 2; axis++) planeEdges[p][axis].assign(lattice, 0);
+        }
+        zEdges.assign(lattice, 0);
+
+        int words = packedWords(cols);
+        zeroRow.assign(words + 1, 0);
+        anyRow.assign(words + 1, 0);
+        allRow.assign(words + 1, 0);
+        mixedCells.assign(packedWords(cols + 1), 0);
+
+        out->text("# Malla generada por marching cubes (");
+        out->integer(cols);
+        out->put('x');
+        out->integer(rows);
+        out->text(")\n");
+    }
+
+    // Añadir la siguiente imagen (valores > threshold son objeto) y mallar la capa
+    // entre ella y la anterior
+    void addSlice(const cv::Mat& image, uchar threshold = 127) {
+        int slot = slicesAdded & 1;
+        planes.packSlice(slot, image, threshold);
+
+        BitSliceView lower = planes.slice(slot ^ 1), upper = planes.slice(slot);
+        int z = firstIndex + slicesAdded;
+        processLayer(slicesAdded > 0 ? &lower : nullptr, &upper, z - 1);
+        slicesAdded++;
+    }
+
+    // Cerrar la malla con la capa entre la última imagen y el fondo
+    void finish() {
+        if (slicesAdded > 0) {
+            BitSliceView last = planes.slice((slicesAdded - 1) & 1);
+            processLayer(&last, nullptr, firstIndex + slicesAdded - 1);
+        }
+        out->flush();
+    }
+
+    int rows() const { return numRows; }
+    int cols() const { return numCols; }
+    long long vertices() const { return vertexCount; }
+    long long triangles() const { return triangleCount; }
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "bit_volume.h"
+
+// Estimación de la memoria que ocupa cargar una pila completa, a partir de la
+// cabecera del TIFF (páginas x alto x ancho) y de los puntos de unas imágenes de
+// muestra, y lectura de la memoria residente del proceso, para elegir una
+// estrategia que quepa en --memory-budget. El presupuesto es orientativo: se
+// eligen la estrategia y los bloques con la estimación, y al terminar se informa
+// si el pico medido lo superó.
+
+// Bytes por punto que se suman a la nube en memoria al guardar el octree (códigos
+// Morton) y al submuestrear (entradas de la rejilla y su copia ordenada, más el
+// orden de los puntos)
+const size_t OCTREE_BYTES_PER_POINT = 16;
+const size_t SAMPLING_BYTES_PER_POINT = 72;
+
+// Escritor asíncrono con presupuesto: bloques más chicos y una cola más corta
+const size_t BUDGET_WRITER_CHUNK = 1 << 18;
+const size_t BUDGET_WRITER_QUEUE = 2;
+
+// Memoria de un AsyncFileWriter: el bloque que se llena, los encolados y el que
+// está escribiendo el hilo
+inline size_t writerBytes(size_t chunkBytes, size_t queueDepth) {
+    return chunkBytes * (queueDepth + 2);
+}
+
+// Memoria de la carga completa de una pila, sin la nube de puntos ni el escritor
+struct MemoryEstimate {
+    int pages = 0;
+    int rows = 0;
+    int cols = 0;
+    size_t sliceBytes = 0;      // Por imagen cargada: bits, ocupación y, con RLE, tramos
+    size_t pageBytes = 0;       // Por hilo: página decodificada a 8 bits
+    size_t points = 0;          // Puntos de la extracción, según las imágenes de muestra
+
+    size_t volumeBytes() const { return sliceBytes * pages; }
+    size_t total(int threads) const { return volumeBytes() + pageBytes * threads; }
+
+    // Modo streaming: una página por hilo, la ventana de tres imágenes de la
+    // superficie 3D y los puntos de las imágenes en curso
+    size_t streamBytes(int threads, size_t pointBytes) const {
+        size_t pagePoints = pages > 0 ? points / pages + 1 : 0;
+        return pageBytes * threads + 3 * sliceBytes + 2 * threads * pagePoints * pointBytes;
+    }
+};
+
+inline MemoryEstimate estimateStackMemory(int pages, int rows, int cols, bool runLength) {
+    MemoryEstimate estimate;
+    estimate.pages = pages;
+    estimate.rows = rows;
+    estimate.cols = cols;
+
+    int words = packedWords(cols);
+    size_t packed = (size_t)rows * words * sizeof(uint64_t);
+    size_t tiles = (size_t)((rows + SliceOccupancy::TILE_ROWS - 1) / SliceOccupancy::TILE_ROWS) *
+                   packedWords(words) * sizeof(uint64_t);
+    estimate.sliceBytes = packed + tiles;
+    if (runLength) {
+        // Los tramos dependen del contenido: se cuenta el índice de filas y, para
+        // los tramos, lo mismo que la imagen empaquetada
+        estimate.sliceBytes += (size_t)(rows + 1) * sizeof(uint32_t) + packed;
+    }
+    estimate.pageBytes = (size_t)rows * cols;
+    return estimate;
+}
+
+// Tamaño con sufijo opcional K, M o G (potencias de 1024), p. ej. "512M"
+inline bool parseByteSize(const std::string& text, size_t& bytes) {
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (end == text.c_str() || !(value > 0)) return false;
+
+    double scale = 1;
+    std::string suffix(end);
+    if (suffix == "K" || suffix == "k") scale = 1024.0;
+    else if (suffix == "M" || suffix == "m") scale = 1024.0 * 1024;
+    else if (suffix == "G" || suffix == "g") scale = 1024.0 * 1024 * 1024;
+    else if (!suffix.empty()) return false;
+
+    bytes = (size_t)(value * scale);
+    return true;
+}
+
+inline std::string formatBytes(size_t bytes) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1f MB", bytes / (1024.0 * 1024.0));
+    return text;
+}
+
+// Memoria residente actual del proceso (0 si no se puede leer)
+inline size_t currentResidentBytes() {
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    unsigned long size = 0, resident = 0;
+    int fields = std::fscanf(statm, "%lu %lu", &size, &resident);
+    std::fclose(statm);
+    return fields == 2 ? (size_t)resident * (size_t)sysconf(_SC_PAGESIZE) : 0;
+}
+
+// Pico de memoria residente del proceso (ru_maxrss está en KB en Linux)
+inline size_t peakResidentBytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return (size_t)usage.ru_maxrss * 1024;
+}
+
+#endif
@@ -0,0 +1,400 @@
+#ifndef OCTREE_CODEC_H
+#define OCTREE_CODEC_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <climits>
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include "byte_codec.h"
+#include "parallel_for.h"
+
+// Compresión de nubes de puntos sobre la rejilla entera de vóxeles mediante un
+// octree de ocupación. Cada nodo interno se describe con un byte (bit c = hijo c
+// ocupado) y ese byte se codifica con un codificador aritmético binario adaptativo
+// (8 decisiones por byte, contexto = bits ya codificados y distancia a las hojas).
+//
+// Los niveles superiores se codifican en un trozo propio; cada nodo del nivel de
+// corte es la raíz de un subárbol codificado de forma independiente (su propio
+// codificador y modelo), así que los subárboles se comprimen y descomprimen en
+// paralelo. El octree representa un conjunto: los puntos repetidos se guardan una
+// vez y al decodificar salen en orden de Morton, no en el orden original.
+//
+//   archivo = "OCTP" versión(1) 0 0 0
+//             int32 origen x, y, z   uint8 profundidad   uint8 nivelCorte   uint16 0
+//             uint64 puntos   uint32 subárboles   uint32 bytesTrozoSuperior
+//             por subárbol: uint32 bytes, uint32 puntos
+//             trozo superior, trozos de los subárboles
+//
+// Todos los enteros son little-endian.
+
+const char OCTREE_MAGIC[4] = { 'O', 'C', 'T', 'P' };
+const size_t OCTREE_HEADER_BYTES = 40;
+const int OCTREE_MAX_DEPTH = 21;       // 3 x 21 bits caben en un código de Morton de 64 bits
+const int OCTREE_SPLIT_LEVEL = 3;      // Hasta 512 subárboles independientes
+
+// Cota de puntos por byte comprimido: una decisión cuesta al menos
+// -log2(2017/2048) ~ 0,022 bits (probabilidad saturada), o sea unas 365 por byte,
+// y cada hoja necesita al menos una decisión (un byte de ocupación por cada ocho)
+const uint64_t OCTREE_MAX_POINTS_PER_BYTE = 512;
+
+// Codificador aritmético binario (esquema de rango de LZMA): probabilidades de
+// 11 bits, adaptación con desplazamiento 5, renormalización por bytes
+class RangeEncoder {
+private:
+    std::vector<uint8_t>& out;
+    uint64_t low = 0;
+    uint32_t range = 0xFFFFFFFF;
+    uint8_t cache = 0;
+    uint64_t cacheSize = 1;
+
+    void shiftLow() {
+        if ((uint32_t)low < 0xFF000000 || (low >> 32) != 0) {
+            uint8_t carry = (uint8_t)(low >> 32);
+            uint8_t temp = cache;
+            do {
+                out.push_back((uint8_t)(temp + carry));
+                temp = 0xFF;
+            } while (--cacheSize != 0);
+            cache = (uint8_t)(low >> 24);
+        }
+        cacheSize++;
+        low = (low & 0x00FFFFFF) << 8;
+    }
+
+public:
+    explicit RangeEncoder(std::vector<uint8_t>& output) : out(output) {}
+
+    void encodeBit(uint16_t& prob, int bit) {
+        uint32_t bound = (range >> 11) * prob;
+        if (!bit) {
+            range = bound;
+            prob += (2048 - prob) >> 5;
+        } else {
+            low += bound;
+            range -= bound;
+            prob -= prob >> 5;
+        }
+        while (range < (1u << 24)) {
+            range <<= 8;
+            shiftLow();
+        }
+    }
+
+    void flush() {
+        for (int i = 0; i < 5; i++) shiftLow();
+    }
+};
+
+class RangeDecoder {
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+    uint32_t range = 0xFFFFFFFF;
+    uint32_t code = 0;
+
+    uint8_t next() {
+        return p < end ? *p++ : 0;
+    }
+
+public:
+    RangeDecoder(const uint8_t* data, size_t size) : p(data), end(data + size) {
+        for (int i = 0; i < 5; i++) code = (code << 8) | next();
+    }
+
+    int decodeBit(uint16_t& prob) {
+        uint32_t bound = (range >> 11) * prob;
+        int bit;
+        if (code < bound) {
+            range = bound;
+            prob += (2048 - prob) >> 5;
+            bit = 0;
+        } else {
+            code -= bound;
+            range -= bound;
+            prob -= prob >> 5;
+            bit = 1;
+        }
+        while (range < (1u << 24)) {
+            range <<= 8;
+            code = (code << 8) | next();
+        }
+        return bit;
+    }
+};
+
+// Modelo adaptativo del byte de ocupación: un árbol binario de 255 contextos por
+// cada grupo de nivel (padres de hojas, de nietos, ... y el resto)
+struct OccupancyModel {
+    static const int LEVEL_GROUPS = 4;
+    uint16_t probs[LEVEL_GROUPS][256];
+
+    OccupancyModel() {
+        for (auto& group : probs) std::fill(group, group + 256, (uint16_t)1024);
+    }
+
+    static int group(int levelsBelow) {
+        return std::min(levelsBelow, LEVEL_GROUPS) - 1;
+    }
+
+    void encode(RangeEncoder& coder, int levelsBelow, int byte) {
+        uint16_t* tree = probs[group(levelsBelow)];
+        int context = 1;
+        for (int bit = 7; bit >= 0; bit--) {
+            int value = (byte >> bit) & 1;
+            coder.encodeBit(tree[context], value);
+            context = (context << 1) | value;
+        }
+    }
+
+    int decode(RangeDecoder& coder, int levelsBelow) {
+        uint16_t* tree = probs[group(levelsBelow)];
+        int context = 1;
+        while (context < 256) context = (context << 1) | coder.decodeBit(tree[context]);
+        return context - 256;
+    }
+};
+
+inline uint64_t spreadBits3(uint64_t v) {
+    v &= 0x1FFFFF;
+    v = (v | v << 32) & 0x001F00000000FFFFULL;
+    v = (v | v << 16) & 0x001F0000FF0000FFULL;
+    v = (v | v << 8) & 0x100F00F00F00F00FULL;
+    v = (v | v << 4) & 0x10C30C30C30C30C3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+}
+
+inline uint32_t compactBits3(uint64_t v) {
+    v &= 0x1249249249249249ULL;
+    v = (v ^ (v >> 2)) & 0x10C30C30C30C30C3ULL;
+    v = (v ^ (v >> 4)) & 0x100F00F00F00F00FULL;
+    v = (v ^ (v >> 8)) & 0x001F0000FF0000FFULL;
+    v = (v ^ (v >> 16)) & 0x001F00000000FFFFULL;
+    v = (v ^ (v >> 32)) & 0x1FFFFF;
+    return (uint32_t)v;
+}
+
+// Código de Morton: bit 3k = x_k, 3k+1 = y_k, 3k+2 = z_k (hijo c: bit0 x, bit1 y, bit2 z)
+inline uint64_t mortonEncode(uint32_t x, uint32_t y, uint32_t z) {
+    return spreadBits3(x) | (spreadBits3(y) << 1) | (spreadBits3(z) << 2);
+}
+
+// Codificar los códigos ordenados [lo, hi) del nodo de nivel 'level' cuyos hijos
+// están en el nivel level + 1, hasta 'stopLevel' (las raíces alcanzadas se guardan
+// en 'roots' como rangos de códigos)
+inline void encodeOctreeNode(const std::vector<uint64_t>& codes, size_t lo, size_t hi, int level, int stopLevel,
+                             int depth, RangeEncoder& coder, OccupancyModel& model,
+                             std::vector<std::pair<size_t, size_t>>* roots) {
+    if (level == stopLevel) {
+        if (roots) roots->push_back(std::make_pair(lo, hi));
+        return;
+    }
+    const int shift = 3 * (depth - 1 - level);
+    size_t bounds[9];
+    bounds[0] = lo;
+    int occupancy = 0;
+    size_t i = lo;
+    for (int c = 0; c < 8; c++) {
+        while (i < hi && (int)((codes[i] >> shift) & 7) == c) i++;
+        bounds[c + 1] = i;
+        if (bounds[c + 1] > bounds[c]) occupancy |= 1 << c;
+    }
+    model.encode(coder, depth - level, occupancy);
+    for (int c = 0; c < 8; c++) {
+        if (occupancy & (1 << c)) {
+            encodeOctreeNode(codes, bounds[c], bounds[c + 1], level + 1, stopLevel, depth, coder, model, roots);
+        }
+    }
+}
+
+// Decodificar el nodo 'prefix' (código de Morton de sus niveles superiores) y
+// llamar emit(código) por cada nodo alcanzado en 'stopLevel', en orden de Morton.
+// Si emit devuelve false (datos dañados) se abandona el recorrido.
+template <typename Emit>
+inline bool decodeOctreeNode(uint64_t prefix, int level, int stopLevel, int depth,
+                             RangeDecoder& coder, OccupancyModel& model, Emit& emit) {
+    if (level == stopLevel) {
+        return emit(prefix);
+    }
+    int occupancy = model.decode(coder, depth - level);
+    for (int c = 0; c < 8; c++) {
+        if ((occupancy & (1 << c)) &&
+            !decodeOctreeNode((prefix << 3) | c, level + 1, stopLevel, depth, coder, model, emit)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Comprimir una nube de puntos de coordenadas enteras. Devuelve false (con
+// mensaje) si alguna coordenada no es entera o la extensión no cabe en el octree.
+template <typename Point>
+inline bool encodeOctree(const std::vector<Point>& points, std::vector<uint8_t>& out, int threads = 1) {
+    out.clear();
+    int64_t minimum[3] = { 0, 0, 0 }, maximum[3] = { 0, 0, 0 };
+    for (size_t i = 0; i < points.size(); i++) {
+        const double values[3] = { (double)points[i].x, (double)points[i].y, (double)points[i].z };
+        for (int a = 0; a < 3; a++) {
+            if (!(std::fabs(values[a]) < 2e9) || values[a] != std::floor(values[a])) {
+                std::cerr << "Error: El octree solo admite coordenadas enteras" << std::endl;
+                return false;
+            }
+            int64_t v = (int64_t)values[a];
+            if (i == 0 || v < minimum[a]) minimum[a] = v;
+            if (i == 0 || v > maximum[a]) maximum[a] = v;
+        }
+    }
+
+    int depth = 1;
+    int64_t extent = std::max(maximum[0] - minimum[0], std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]));
+    while (depth < OCTREE_MAX_DEPTH && (int64_t(1) << depth) <= extent) depth++;
+    if ((int64_t(1) << depth) <= extent) {
+        std::cerr << "Error: La nube es demasiado extensa para el octree" << std::endl;
+        return false;
+    }
+    const int splitLevel = std::min(OCTREE_SPLIT_LEVEL, depth - 1);
+
+    std::vector<uint64_t> codes(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        codes[i] = mortonEncode((uint32_t)((int64_t)points[i].x - minimum[0]),
+                                (uint32_t)((int64_t)points[i].y - minimum[1]),
+                                (uint32_t)((int64_t)points[i].z - minimum[2]));
+    }
+    std::sort(codes.begin(), codes.end());
+    codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+
+    // Niveles superiores, que además reparten los códigos entre los subárboles
+    std::vector<uint8_t> top;
+    std::vector<std::pair<size_t, size_t>> roots;
+    if (!codes.empty()) {
+        RangeEncoder coder(top);
+        OccupancyModel model;
+        encodeOctreeNode(codes, 0, codes.size(), 0, splitLevel, depth, coder, model, &roots);
+        coder.flush();
+    }
+
+    std::vector<std::vector<uint8_t>> chunks(roots.size());
+    parallelFor(roots.size(), threads, [&](size_t s, int) {
+        RangeEncoder coder(chunks[s]);
+        OccupancyModel model;
+        encodeOctreeNode(codes, roots[s].first, roots[s].second, splitLevel, depth, depth, coder, model, nullptr);
+        coder.flush();
+    });
+
+    out.insert(out.end(), OCTREE_MAGIC, OCTREE_MAGIC + 4);
+    out.push_back(1);
+    out.resize(8, 0);
+    for (int a = 0; a < 3; a++) putLE(out, (uint32_t)(int32_t)minimum[a], 4);
+    out.push_back((uint8_t)depth);
+    out.push_back((uint8_t)splitLevel);
+    putLE(out, 0, 2);
+    putLE(out, codes.size(), 8);
+    putLE(out, roots.size(), 4);
+    putLE(out, top.size(), 4);
+    for (size_t s = 0; s < roots.size(); s++) {
+        putLE(out, chunks[s].size(), 4);
+        putLE(out, roots[s].second - roots[s].first, 4);
+    }
+    out.insert(out.end(), top.begin(), top.end());
+    for (const auto& chunk : chunks) out.insert(out.end(), chunk.begin(), chunk.end());
+    return true;
+}
+
+inline bool isOctreeFile(const char* data, size_t size) {
+    return size >= OCTREE_HEADER_BYTES && std::memcmp(data, OCTREE_MAGIC, 4) == 0;
+}
+
+// Descomprimir a 'points' (Point con miembros x, y, z). Cada subárbol escribe en
+// su propio tramo del vector, conocido por el índice, así que se decodifican en
+// paralelo sin sincronización.
+template <typename Point>
+inline bool decodeOctree(const char* data, size_t size, std::vector<Point>& points, int threads = 1) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    points.clear();
+    if (!isOctreeFile(data, size) || bytes[4] != 1) {
+        std::cerr << "Error: Archivo octree inválido o de versión no soportada" << std::endl;
+        return false;
+    }
+    const int32_t origin[3] = { (int32_t)loadLE(bytes + 8, 4), (int32_t)loadLE(bytes + 12, 4),
+                                (int32_t)loadLE(bytes + 16, 4) };
+    const int depth = bytes[20];
+    const int splitLevel = bytes[21];
+    const uint64_t totalPoints = loadLE(bytes + 24, 8);
+    const size_t subtrees = (size_t)loadLE(bytes + 32, 4);
+    const size_t topBytes = (size_t)loadLE(bytes + 36, 4);
+
+    const size_t indexBytes = subtrees * 8;
+    if (totalPoints > (uint64_t)size * OCTREE_MAX_POINTS_PER_BYTE) {
+        std::cerr << "Error: Cabecera del octree dañada (" << totalPoints << " puntos en "
+                  << size << " bytes)" << std::endl;
+        return false;
+    }
+    if (depth < 1 || depth > OCTREE_MAX_DEPTH || splitLevel >= depth || subtrees > (size_t(1) << (3 * splitLevel)) ||
+        OCTREE_HEADER_BYTES + indexBytes + topBytes > size) {
+        std::cerr << "Error: Cabecera del octree dañada" << std::endl;
+        return false;
+    }
+
+    // Posición de cada trozo y de sus puntos en el vector de salida
+    const uint8_t* index = bytes + OCTREE_HEADER_BYTES;
+    std::vector<size_t> chunkStart(subtrees + 1), pointStart(subtrees + 1);
+    chunkStart[0] = OCTREE_HEADER_BYTES + indexBytes + topBytes;
+    pointStart[0] = 0;
+    for (size_t s = 0; s < subtrees; s++) {
+        chunkStart[s + 1] = chunkStart[s] + (size_t)loadLE(index + 8 * s, 4);
+        pointStart[s + 1] = pointStart[s] + (size_t)loadLE(index + 8 * s + 4, 4);
+    }
+    if (chunkStart[subtrees] != size || pointStart[subtrees] != totalPoints) {
+        std::cerr << "Error: Índice del octree dañado" << std::endl;
+        return false;
+    }
+
+    // Raíces de los subárboles, en el mismo orden en que se escribieron los trozos
+    std::vector<uint64_t> roots;
+    if (subtrees > 0) {
+        RangeDecoder coder(bytes + OCTREE_HEADER_BYTES + indexBytes, topBytes);
+        OccupancyModel model;
+        auto collect = [&](uint64_t code) {
+            roots.push_back(code);
+            return roots.size() <= subtrees;
+        };
+        decodeOctreeNode(0, 0, splitLevel, depth, coder, model, collect);
+    }
+    if (roots.size() != subtrees) {
+        std::cerr << "Error: Niveles superiores del octree dañados" << std::endl;
+        return false;
+    }
+
+    points.resize((size_t)totalPoints);
+    std::atomic<bool> failed(false);
+    parallelFor(subtrees, threads, [&](size_t s, int) {
+        RangeDecoder coder(bytes + chunkStart[s], chunkStart[s + 1] - chunkStart[s]);
+        OccupancyModel model;
+        Point* dst = points.data() + pointStart[s];
+        Point* const end = points.data() + pointStart[s + 1];
+        auto emit = [&](uint64_t code) {
+            if (dst == end) return false;
+            dst->x = (float)((int64_t)compactBits3(code) + origin[0]);
+            dst->y = (float)((int64_t)compactBits3(code >> 1) + origin[1]);
+            dst->z = (float)((int64_t)compactBits3(code >> 2) + origin[2]);
+            dst++;
+            return true;
+        };
+        if (!decodeOctreeNode(roots[s], splitLevel, depth, depth, coder, model, emit) || dst != end) {
+            failed = true;
+        }
+    });
+
+    if (failed) {
+        std::cerr << "Error: Subárbol del octree dañado" << std::endl;
+        points.clear();
+        return false;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+
+// Ejecutar fn(i, hilo) para cada i de [0, count) con hasta 'threads' hilos
+// (hilo en [0, threads), para búferes propios de cada hilo). Los hilos toman el
+// siguiente índice libre de un contador compartido, así el reparto se equilibra
+// aunque unas tareas cuesten más que otras. Con un hilo no se crea ninguno.
+template <typename Fn>
+inline void parallelFor(size_t count, int threads, Fn fn) {
+    int workers = (int)std::min<size_t>(std::max(threads, 1), count);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; i++) fn(i, 0);
+        return;
+    }
+    std::atomic<size_t> nextItem(0);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < workers; t++) {
+        pool.emplace_back([&, t] {
+            for (size_t i = nextItem++; i < count; i = nextItem++) fn(i, t);
+        });
+    }
+    for (auto& thread : pool) thread.join();
+}
+
+#endif
@@ -0,0 +1,419 @@
+#ifndef POINT_CLOUD_IO_H
+#define POINT_CLOUD_IO_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <ostream>
+#include <iostream>
+#include <type_traits>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Nubes de puntos binarias: PLY 'binary_little_endian' y PCD 'DATA binary' con
+// tres campos float x y z por punto (12 bytes). El extractor las escribe y los
+// visualizadores las cargan proyectando el archivo en memoria (mmap) y copiando
+// los registros directamente al vector de puntos, sin interpretar texto.
+
+inline bool hostIsLittleEndian() {
+    const uint16_t one = 1;
+    return *(const unsigned char*)&one == 1;
+}
+
+inline void storeFloatLE(float value, unsigned char* dst) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+    dst[0] = (unsigned char)bits;
+    dst[1] = (unsigned char)(bits >> 8);
+    dst[2] = (unsigned char)(bits >> 16);
+    dst[3] = (unsigned char)(bits >> 24);
+}
+
+inline float loadFloat(const unsigned char* src, bool bigEndian) {
+    uint32_t bits = bigEndian
+        ? ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8) | src[3]
+        : ((uint32_t)src[3] << 24) | ((uint32_t)src[2] << 16) | ((uint32_t)src[1] << 8) | src[0];
+    float value;
+    std::memcpy(&value, &bits, 4);
+    return value;
+}
+
+inline void writeBinaryPLYHeader(std::ostream& out, size_t count) {
+    out << "ply\n";
+    out << "format binary_little_endian 1.0\n";
+    out << "element vertex " << count << "\n";
+    out << "property float x\n";
+    out << "property float y\n";
+    out << "property float z\n";
+    out << "end_header\n";
+}
+
+inline void writeBinaryPCDHeader(std::ostream& out, size_t count) {
+    out << "# .PCD v0.7 - Point Cloud Data file format\n";
+    out << "VERSION 0.7\n";
+    out << "FIELDS x y z\n";
+    out << "SIZE 4 4 4\n";
+    out << "TYPE F F F\n";
+    out << "COUNT 1 1 1\n";
+    out << "WIDTH " << count << "\n";
+    out << "HEIGHT 1\n";
+    out << "VIEWPOINT 0 0 0 1 0 0 0\n";
+    out << "POINTS " << count << "\n";
+    out << "DATA binary\n";
+}
+
+const size_t BINARY_POINT_BYTES = 12;
+
+// Convertir 'count' puntos en registros de tres float little-endian a partir de 'dst'
+template <typename Point>
+inline void storeBinaryPoints(const Point* points, size_t count, unsigned char* dst) {
+    for (size_t i = 0; i < count; i++, dst += BINARY_POINT_BYTES) {
+        storeFloatLE((float)points[i].x, dst);
+        storeFloatLE((float)points[i].y, dst + 4);
+        storeFloatLE((float)points[i].z, dst + 8);
+    }
+}
+
+// Archivo proyectado en memoria de solo lectura (POSIX mmap)
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        close();
+    }
+
+    bool open(const std::string& filename) {
+        close();
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        length = (size_t)info.st_size;
+        if (length > 0) {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                length = 0;
+                return false;
+            }
+            madvise(mapped, length, MADV_SEQUENTIAL);
+            bytes = (const char*)mapped;
+        }
+        // La proyección sigue siendo válida tras cerrar el descriptor
+        ::close(fd);
+        return true;
+    }
+
+    void close() {
+        if (bytes) munmap((void*)bytes, length);
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+// Archivo de salida de tamaño conocido proyectado en memoria para escritura: se
+// reserva entero al crearlo (así un disco lleno falla aquí y no al escribir en la
+// proyección) y varios hilos pueden llenar regiones distintas a la vez
+class MappedOutputFile {
+private:
+    int fd = -1;
+    unsigned char* bytes = nullptr;
+    size_t length = 0;
+
+public:
+    MappedOutputFile() = default;
+    MappedOutputFile(const MappedOutputFile&) = delete;
+    MappedOutputFile& operator=(const MappedOutputFile&) = delete;
+
+    ~MappedOutputFile() {
+        close();
+    }
+
+    bool create(const std::string& filename, size_t size) {
+        close();
+        fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+
+        length = size;
+        if (length > 0) {
+            // Algunos sistemas de archivos no admiten reservar bloques; entonces
+            // basta con fijar el tamaño
+            int reserved = posix_fallocate(fd, 0, (off_t)length);
+            bool sized = reserved == 0 ||
+                         ((reserved == EOPNOTSUPP || reserved == EINVAL) && ftruncate(fd, (off_t)length) == 0);
+            void* mapped = sized ? mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                fd = -1;
+                length = 0;
+                return false;
+            }
+            bytes = (unsigned char*)mapped;
+        }
+        return true;
+    }
+
+    // Terminar el archivo; false si no se pudo escribir completo
+    bool close() {
+        if (fd < 0) return true;
+        bool ok = true;
+        if (bytes) ok = munmap(bytes, length) == 0;
+        ok = ::close(fd) == 0 && ok;
+        fd = -1;
+        bytes = nullptr;
+        length = 0;
+        return ok;
+    }
+
+    // Sacar de la memoria del proceso las páginas ya escritas de [offset, offset +
+    // size): los datos siguen en la caché del sistema de archivos y se escriben en
+    // disco igual, pero el archivo proyectado deja de sumar a la memoria residente.
+    // Solo se liberan las páginas enteras del rango, así que distintos hilos pueden
+    // liberar regiones contiguas.
+    void release(size_t offset, size_t size) {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t first = (offset + page - 1) / page * page;
+        size_t last = std::min(offset + size, length) / page * page;
+        if (bytes && first < last) madvise(bytes + first, last - first, MADV_DONTNEED);
+    }
+
+    unsigned char* data() { return bytes; }
+    size_t size() const { return length; }
+};
+
+enum class PointFileFormat { Ascii, BinaryPLY, BinaryPCD };
+
+// Disposición de los registros binarios descrita por la cabecera
+struct PointFileLayout {
+    PointFileFormat format = PointFileFormat::Ascii;
+    size_t count = 0;            // Número de puntos
+    size_t dataOffset = 0;       // Primer byte después de la cabecera
+    size_t stride = 0;           // Bytes por punto
+    size_t offsets[3] = { 0, 0, 0 }; // Posición de x, y, z dentro del registro
+    bool bigEndian = false;
+};
+
+// Leer la siguiente línea de la cabecera (sin '\n' ni '\r'); false al final del archivo
+inline bool nextHeaderLine(const char* data, size_t size, size_t& pos, std::string& line) {
+    if (pos >= size) return false;
+    const char* start = data + pos;
+    const char* end = (const char*)std::memchr(start, '\n', size - pos);
+    size_t length = end ? (size_t)(end - start) : size - pos;
+    pos += length + (end ? 1 : 0);
+    if (length > 0 && start[length - 1] == '\r') length--;
+    line.assign(start, length);
+    return true;
+}
+
+inline std::vector<std::string> splitWords(const std::string& line) {
+    std::vector<std::string> words;
+    size_t pos = 0;
+    while (pos < line.size()) {
+        size_t start = line.find_first_not_of(" \t", pos);
+        if (start == std::string::npos) break;
+        size_t end = line.find_first_of(" \t", start);
+        if (end == std::string::npos) end = line.size();
+        words.push_back(line.substr(start, end - start));
+        pos = end;
+    }
+    return words;
+}
+
+inline size_t plyTypeSize(const std::string& type) {
+    if (type == "char" || type == "uchar" || type == "int8" || type == "uint8") return 1;
+    if (type == "short" || type == "ushort" || type == "int16" || type == "uint16") return 2;
+    if (type == "int" || type == "uint" || type == "float" || type == "int32" || type == "uint32" || type == "float32") return 4;
+    if (type == "double" || type == "float64") return 8;
+    return 0;
+}
+
+// Interpretar la cabecera PLY binaria: los vértices deben ser el primer elemento,
+// sin propiedades de lista, y x, y, z de tipo float
+inline bool parsePLYLayout(const char* data, size_t size, PointFileLayout& layout) {
+    size_t pos = 0;
+    std::string line;
+    bool inVertex = false, seenElement = false;
+    bool found[3] = { false, false, false };
+
+    while (nextHeaderLine(data, size, pos, line)) {
+        std::vector<std::string> words = splitWords(line);
+        if (words.empty() || words[0] == "comment" || words[0] == "obj_info") continue;
+
+        if (words[0] == "end_header") {
+            layout.dataOffset = pos;
+            if (layout.format == PointFileFormat::Ascii) return true;
+            if (!found[0] || !found[1] || !found[2]) {
+                std::cerr << "Error: La cabecera PLY no tiene propiedades float x, y, z" << std::endl;
+                return false;
+            }
+            return true;
+        } else if (words[0] == "format" && words.size() >= 2) {
+            if (words[1] == "binary_little_endian" || words[1] == "binary_big_endian") {
+                layout.format = PointFileFormat::BinaryPLY;
+                layout.bigEndian = (words[1] == "binary_big_endian");
+            }
+        } else if (words[0] == "element" && words.size() >= 3) {
+            inVertex = (words[1] == "vertex") && !seenElement;
+            if (words[1] == "vertex" && seenElement && layout.format != PointFileFormat::Ascii) {
+                std::cerr << "Error: PLY binario con elementos antes de los vértices no soportado" << std::endl;
+                return false;
+            }
+            seenElement = true;
+            if (inVertex) layout.count = (size_t)std::strtoull(words[2].c_str(), nullptr, 10);
+        } else if (words[0] == "property" && inVertex && words.size() >= 3) {
+            size_t bytes = plyTypeSize(words[1]);
+            if (bytes == 0) {
+                if (layout.format == PointFileFormat::Ascii) continue;
+                std::cerr << "Error: Propiedad PLY no soportada: " << line << std::endl;
+                return false;
+            }
+            const std::string& name = words[2];
+            int axis = (name == "x") ? 0 : (name == "y") ? 1 : (name == "z") ? 2 : -1;
+            if (axis >= 0) {
+                if (bytes != 4 || (words[1] != "float" && words[1] != "float32")) {
+                    if (layout.format == PointFileFormat::Ascii) continue;
+                    std::cerr << "Error: La coordenada " << name << " del PLY no es float" << std::endl;
+                    return false;
+                }
+                layout.offsets[axis] = layout.stride;
+                found[axis] = true;
+            }
+            layout.stride += bytes;
+        }
+    }
+    std::cerr << "Error: Cabecera PLY sin 'end_header'" << std::endl;
+    return false;
+}
+
+// Interpretar la cabecera PCD: FIELDS/SIZE/TYPE/COUNT describen el registro
+inline bool parsePCDLayout(const char* data, size_t size, PointFileLayout& layout) {
+    size_t pos = 0;
+    std::string line;
+    std::vector<std::string> fields, sizes, types, counts;
+
+    while (nextHeaderLine(data, size, pos, line)) {
+        std::vector<std::string> words = splitWords(line);
+        if (words.empty() || words[0][0] == '#') continue;
+        std::vector<std::string> values(words.begin() + 1, words.end());
+
+        if (words[0] == "FIELDS") fields = values;
+        else if (words[0] == "SIZE") sizes = values;
+        else if (words[0] == "TYPE") types = values;
+        else if (words[0] == "COUNT") counts = values;
+        else if (words[0] == "POINTS" && !values.empty()) layout.count = (size_t)std::strtoull(values[0].c_str(), nullptr, 10);
+        else if (words[0] == "DATA") {
+            layout.dataOffset = pos;
+            std::string kind = values.empty() ? "" : values[0];
+            if (kind == "ascii") return true;
+            if (kind != "binary") {
+                std::cerr << "Error: Formato PCD no soportado: DATA " << kind << std::endl;
+                return false;
+            }
+            layout.format = PointFileFormat::BinaryPCD;
+            if (sizes.size() != fields.size() || types.size() != fields.size()) {
+                std::cerr << "Error: Cabecera PCD incompleta" << std::endl;
+                return false;
+            }
+            bool found[3] = { false, false, false };
+            for (size_t f = 0; f < fields.size(); f++) {
+                size_t bytes = (size_t)std::atoi(sizes[f].c_str());
+                size_t repeat = (f < counts.size()) ? (size_t)std::atoi(counts[f].c_str()) : 1;
+                int axis = (fields[f] == "x") ? 0 : (fields[f] == "y") ? 1 : (fields[f] == "z") ? 2 : -1;
+                if (axis >= 0) {
+                    if (bytes != 4 || types[f] != "F") {
+                        std::cerr << "Error: La coordenada " << fields[f] << " del PCD no es float" << std::endl;
+                        return false;
+                    }
+                    layout.offsets[axis] = layout.stride;
+                    found[axis] = true;
+                }
+                layout.stride += bytes * repeat;
+            }
+            if (!found[0] || !found[1] || !found[2]) {
+                std::cerr << "Error: La cabecera PCD no tiene campos x, y, z" << std::endl;
+                return false;
+            }
+            return true;
+        }
+    }
+    std::cerr << "Error: Cabecera PCD sin línea DATA" << std::endl;
+    return false;
+}
+
+// Un PCD empieza (tras los comentarios '#') por VERSION o FIELDS; un XYZ con
+// comentarios empieza directamente por números
+inline bool isPCDHeader(const char* data, size_t size) {
+    size_t pos = 0;
+    std::string line;
+    while (nextHeaderLine(data, size, pos, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        return line.compare(0, 7, "VERSION") == 0 || line.compare(0, 6, "FIELDS") == 0;
+    }
+    return false;
+}
+
+// Detectar el formato por la cabecera (no por la extensión). Devuelve false si la
+// cabecera es inválida o el archivo no es coherente con ella; los archivos que no
+// son PLY ni PCD se tratan como texto ASCII.
+inline bool parsePointFileLayout(const char* data, size_t size, PointFileLayout& layout) {
+    layout = PointFileLayout();
+    bool ok;
+    if (size >= 4 && std::memcmp(data, "ply", 3) == 0 && (data[3] == '\n' || data[3] == '\r')) {
+        ok = parsePLYLayout(data, size, layout);
+    } else if (isPCDHeader(data, size)) {
+        ok = parsePCDLayout(data, size, layout);
+    } else {
+        return true;
+    }
+    if (ok && layout.format != PointFileFormat::Ascii &&
+        (layout.stride == 0 || layout.count > (size - layout.dataOffset) / layout.stride)) {
+        std::cerr << "Error: El archivo es más corto que lo que indica su cabecera" << std::endl;
+        return false;
+    }
+    return ok;
+}
+
+// Copiar los registros binarios al vector de puntos (Point = {float x, y, z}). Si
+// el registro coincide byte a byte con Point, es una sola copia de memoria.
+template <typename Point>
+inline void loadBinaryPoints(const char* data, const PointFileLayout& layout, std::vector<Point>& points) {
+    const unsigned char* src = (const unsigned char*)data + layout.dataOffset;
+    points.resize(layout.count);
+    if (layout.count == 0) return;
+
+    bool sameLayout = std::is_trivially_copyable<Point>::value && sizeof(Point) == 12 && layout.stride == 12 &&
+                      layout.offsets[0] == 0 && layout.offsets[1] == 4 && layout.offsets[2] == 8 &&
+                      layout.bigEndian == !hostIsLittleEndian();
+    if (sameLayout) {
+        std::memcpy((void*)points.data(), src, layout.count * 12);
+        return;
+    }
+
+    for (size_t i = 0; i < layout.count; i++, src += layout.stride) {
+        points[i].x = loadFloat(src + layout.offsets[0], layout.bigEndian);
+        points[i].y = loadFloat(src + layout.offsets[1], layout.bigEndian);
+        points[i].z = loadFloat(src + layout.offsets[2], layout.bigEndian);
+    }
+}
+
+#endif
@@ -0,0 +1,329 @@
+#ifndef POINT_SAMPLING_H
+#define POINT_SAMPLING_H
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+#include "parallel_for.h"
+
+// Submuestreo de nubes de puntos de coordenadas enteras (la rejilla del extractor)
+// para dejarlas dentro de un presupuesto de puntos antes de escribirlas:
+//
+//  - Rejilla de vóxeles: el espacio se divide en celdas cúbicas de lado 'cellSize'
+//    y de cada celda ocupada queda un punto, el más cercano al centroide de los
+//    puntos de la celda.
+//  - Poisson-disk (ruido azul): se aceptan puntos en orden de prioridad
+//    pseudoaleatoria siempre que no haya otro aceptado a menos de 'radius'. El
+//    radio se busca para obtener un número de puntos objetivo.
+//
+// Ambos usan un hash espacial de celdas (clave = coordenadas de la celda) y
+// conservan puntos de la entrada, en su orden original, así que la salida sigue
+// en la rejilla y en orden raster si la entrada lo estaba. La prioridad de cada
+// punto es un hash de sus coordenadas y de la semilla: el resultado no depende del
+// número de hilos ni del orden de la entrada, solo de la semilla.
+
+// Submuestreo pedido en la línea de órdenes (--voxel-grid / --poisson)
+struct PointSampling {
+    double cellSize = 0;        // Lado de la celda de la rejilla de vóxeles (0 = no)
+    size_t targetCount = 0;     // Puntos objetivo del muestreo Poisson-disk (0 = no)
+    uint64_t seed = 1;
+
+    bool enabled() const { return cellSize > 0 || targetCount > 0; }
+};
+
+inline uint64_t samplingMix(uint64_t value) {
+    // Finalizador de splitmix64
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+// Prioridad pseudoaleatoria de un punto: hash de sus coordenadas y de la semilla
+template <typename Point>
+inline uint64_t samplePriority(const Point& point, uint64_t seed) {
+    uint64_t coordinates = (uint64_t)(int64_t)point.z << 42 ^ (uint64_t)(int64_t)point.y << 21 ^ (uint64_t)(int64_t)point.x;
+    return samplingMix(seed ^ samplingMix(coordinates));
+}
+
+// Hash espacial de una nube: los índices de los puntos agrupados por celda de lado
+// 'size' y, dentro de cada celda, por prioridad. Las coordenadas de celda se
+// desplazan para que la celda mínima sea (1, 1, 1) y sus vecinas no sean negativas.
+class SamplingGrid {
+private:
+    static const int KEY_BITS = 21;
+
+    struct Entry {
+        uint64_t key;
+        uint64_t priority;
+        uint32_t index;
+
+        bool operator<(const Entry& other) const {
+            return key != other.key ? key < other.key : priority < other.priority;
+        }
+    };
+
+    std::unordered_map<uint64_t, uint32_t> cellIndex;
+
+public:
+    std::vector<uint32_t> order;       // Índices de los puntos, celda a celda
+    std::vector<uint32_t> cellStart;   // La celda c ocupa order[cellStart[c], cellStart[c + 1])
+    std::vector<uint64_t> cellKeys;
+
+    static uint64_t packKey(int64_t cx, int64_t cy, int64_t cz) {
+        return (uint64_t)cz << (2 * KEY_BITS) | (uint64_t)cy << KEY_BITS | (uint64_t)cx;
+    }
+    static int64_t keyX(uint64_t key) { return (int64_t)(key & ((1ULL << KEY_BITS) - 1)); }
+    static int64_t keyY(uint64_t key) { return (int64_t)(key >> KEY_BITS & ((1ULL << KEY_BITS) - 1)); }
+    static int64_t keyZ(uint64_t key) { return (int64_t)(key >> (2 * KEY_BITS)); }
+
+    // Agrupar los puntos: claves en paralelo, reparto estable por capas de celdas
+    // en z (conteo) y ordenación de cada capa en paralelo
+    template <typename Point>
+    void build(const std::vector<Point>& points, double size, uint64_t seed, int threads) {
+        order.clear();
+        cellStart.clear();
+        cellKeys.clear();
+        cellIndex.clear();
+        if (points.empty()) return;
+
+        int64_t minimum[3] = { points[0].x, points[0].y, points[0].z };
+        int64_t maximumZ = points[0].z;
+        for (const Point& point : points) {
+            minimum[0] = std::min<int64_t>(minimum[0], point.x);
+            minimum[1] = std::min<int64_t>(minimum[1], point.y);
+            minimum[2] = std::min<int64_t>(minimum[2], point.z);
+            maximumZ = std::max<int64_t>(maximumZ, point.z);
+        }
+        auto cell = [&](int64_t value, int axis) {
+            return (int64_t)std::floor((double)(value - minimum[axis]) / size) + 1;
+        };
+
+        const size_t chunk = 1 << 16;
+        std::vector<Entry> entries(points.size());
+        parallelFor((points.size() + chunk - 1) / chunk, threads, [&](size_t c, int) {
+            size_t end = std::min(points.size(), (c + 1) * chunk);
+            for (size_t i = c * chunk; i < end; i++) {
+                const Point& point = points[i];
+                Entry& entry = entries[i];
+                entry.key = packKey(cell(point.x, 0), cell(point.y, 1), cell(point.z, 2));
+                entry.priority = samplePriority(point, seed);
+                entry.index = (uint32_t)i;
+            }
+        });
+
+        std::vector<size_t> layerStart((size_t)cell(maximumZ, 2) + 2, 0);
+        for (const Entry& entry : entries) layerStart[(size_t)keyZ(entry.key) + 1]++;
+        for (size_t l = 1; l < layerStart.size(); l++) layerStart[l] += layerStart[l - 1];
+
+        std::vector<Entry> sorted(entries.size());
+        std::vector<size_t> next(layerStart.begin(), layerStart.end() - 1);
+        for (const Entry& entry : entries) sorted[next[(size_t)keyZ(entry.key)]++] = entry;
+        std::vector<Entry>().swap(entries);
+        parallelFor(layerStart.size() - 1, threads, [&](size_t l, int) {
+            std::sort(sorted.begin() + layerStart[l], sorted.begin() + layerStart[l + 1]);
+        });
+
+        order.resize(sorted.size());
+        for (size_t i = 0; i < sorted.size(); i++) {
+            order[i] = sorted[i].index;
+            if (i == 0 || sorted[i].key != sorted[i - 1].key) {
+                cellIndex.emplace(sorted[i].key, (uint32_t)cellKeys.size());
+                cellKeys.push_back(sorted[i].key);
+                cellStart.push_back((uint32_t)i);
+            }
+        }
+        cellStart.push_back((uint32_t)order.size());
+    }
+
+    size_t cells() const { return cellKeys.size(); }
+
+    // Celda con esa clave, o -1 si no tiene puntos
+    long findCell(uint64_t key) const {
+        auto found = cellIndex.find(key);
+        return found == cellIndex.end() ? -1 : (long)found->second;
+    }
+};
+
+// Conservar los puntos marcados, en su orden original
+template <typename Point>
+inline void keepMarkedPoints(std::vector<Point>& points, const std::vector<char>& keep) {
+    size_t kept = 0;
+    for (size_t i = 0; i < points.size(); i++) {
+        if (keep[i]) points[kept++] = points[i];
+    }
+    points.resize(kept);
+}
+
+// Rejilla de vóxeles de lado 'cellSize' (en unidades de la rejilla, >= 1). En caso
+// de empate con el centroide decide la prioridad del punto.
+template <typename Point>
+inline void voxelGridSample(std::vector<Point>& points, double cellSize, uint64_t seed, int threads) {
+    SamplingGrid grid;
+    grid.build(points, std::max(cellSize, 1.0), seed, threads);
+
+    std::vector<char> keep(points.size(), 0);
+    parallelFor(grid.cells(), threads, [&](size_t c, int) {
+        uint32_t first = grid.cellStart[c], last = grid.cellStart[c + 1];
+        double center[3] = { 0, 0, 0 };
+        for (uint32_t i = first; i < last; i++) {
+            const Point& point = points[grid.order[i]];
+            center[0] += point.x;
+            center[1] += point.y;
+            center[2] += point.z;
+        }
+        for (double& value : center) value /= (last - first);
+
+        // Los puntos de la celda ya están por prioridad: gana el primero más cercano
+        uint32_t best = grid.order[first];
+        double bestDistance = -1;
+        for (uint32_t i = first; i < last; i++) {
+            const Point& point = points[grid.order[i]];
+            double dx = point.x - center[0], dy = point.y - center[1], dz = point.z - center[2];
+            double distance = dx * dx + dy * dy + dz * dz;
+            if (bestDistance < 0 || distance < bestDistance) {
+                bestDistance = distance;
+                best = grid.order[i];
+            }
+        }
+        keep[best] = 1;
+    });
+    keepMarkedPoints(points, keep);
+}
+
+// Marcar en 'keep' una muestra Poisson-disk en la que ningún par de puntos está a
+// distancia al cuadrado menor que 'distance2' y devolver cuántos puntos tiene. El
+// radio es sqrt(distance2); con celdas de ese lado, todo punto a menos de él está
+// en las 27 celdas vecinas, y dos celdas distintas con la misma paridad en x, y, z
+// están separadas al menos por una celda entera. Las celdas se procesan en 8 fases
+// (una por paridad); en cada fase, en paralelo y sin conflictos, ya que las
+// vecinas de una celda son de otra fase. Dentro de una celda los candidatos se
+// prueban en orden de prioridad.
+template <typename Point>
+inline size_t poissonDiskMark(const std::vector<Point>& points, int64_t distance2, uint64_t seed, int threads,
+                              std::vector<char>& keep) {
+    SamplingGrid grid;
+    grid.build(points, std::sqrt((double)distance2), seed, threads);
+
+    std::vector<std::vector<uint32_t>> phaseCells(8);
+    for (size_t c = 0; c < grid.cells(); c++) {
+        uint64_t key = grid.cellKeys[c];
+        int phase = (int)(SamplingGrid::keyX(key) & 1) | (int)(SamplingGrid::keyY(key) & 1) << 1 |
+                    (int)(SamplingGrid::keyZ(key) & 1) << 2;
+        phaseCells[phase].push_back((uint32_t)c);
+    }
+
+    std::vector<std::vector<uint32_t>> accepted(grid.cells());
+    for (const auto& cells : phaseCells) {
+        parallelFor(cells.size(), threads, [&](size_t p, int) {
+            uint32_t c = cells[p];
+            uint64_t key = grid.cellKeys[c];
+            std::vector<const std::vector<uint32_t>*> around;
+            for (int dz = -1; dz <= 1; dz++) {
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        long neighbor = grid.findCell(SamplingGrid::packKey(SamplingGrid::keyX(key) + dx,
+                                                                            SamplingGrid::keyY(key) + dy,
+                                                                            SamplingGrid::keyZ(key) + dz));
+                        if (neighbor >= 0 && (uint32_t)neighbor != c && !accepted[neighbor].empty()) {
+                            around.push_back(&accepted[neighbor]);
+                        }
+                    }
+                }
+            }
+            around.push_back(&accepted[c]);
+
+            for (uint32_t i = grid.cellStart[c]; i < grid.cellStart[c + 1]; i++) {
+                const Point& candidate = points[grid.order[i]];
+                bool free = true;
+                for (size_t a = 0; a < around.size() && free; a++) {
+                    for (uint32_t other : *around[a]) {
+                        int64_t dx = (int64_t)points[other].x - (int64_t)candidate.x;
+                        int64_t dy = (int64_t)points[other].y - (int64_t)candidate.y;
+                        int64_t dz = (int64_t)points[other].z - (int64_t)candidate.z;
+                        if (dx * dx + dy * dy + dz * dz < distance2) {
+                            free = false;
+                            break;
+                        }
+                    }
+                }
+                if (free) accepted[c].push_back(grid.order[i]);
+            }
+        });
+    }
+
+    keep.assign(points.size(), 0);
+    size_t count = 0;
+    for (const auto& cellPoints : accepted) {
+        for (uint32_t index : cellPoints) keep[index] = 1;
+        count += cellPoints.size();
+    }
+    return count;
+}
+
+// Muestra Poisson-disk de exactamente 'target' puntos. En la rejilla las
+// distancias al cuadrado son enteras, así que basta buscar un entero 'distance2':
+// el número de puntos baja al crecer, aproximadamente como 1/distance2 en una
+// superficie, y se busca con esa predicción acotada por el intervalo [demasiados
+// puntos, pocos] (bisección geométrica si se sale de él) hasta que los extremos
+// son consecutivos. De la muestra con menos puntos por encima del objetivo se
+// quitan los de peor prioridad hasta dejar 'target', lo que mantiene la distancia
+// mínima. Devuelve esa distancia mínima (0 si la nube ya cabía y no se tocó).
+template <typename Point>
+inline double poissonDiskSample(std::vector<Point>& points, size_t target, uint64_t seed, int threads) {
+    if (points.size() <= target) return 0;
+
+    // Con distancia 1 se conservan todos los puntos distintos; con la diagonal de la
+    // caja envolvente, uno solo
+    int64_t extent2 = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        auto coordinate = [axis](const Point& point) {
+            return axis == 0 ? (int64_t)point.x : axis == 1 ? (int64_t)point.y : (int64_t)point.z;
+        };
+        auto range = std::minmax_element(points.begin(), points.end(), [&](const Point& a, const Point& b) {
+            return coordinate(a) < coordinate(b);
+        });
+        int64_t extent = coordinate(*range.second) - coordinate(*range.first);
+        extent2 += extent * extent;
+    }
+    int64_t low = 1, high = extent2 + 1;
+    size_t lowCount = points.size();
+
+    std::vector<char> keep, lowKeep;
+    int64_t distance2 = std::max<int64_t>(2, (int64_t)(points.size() / target));
+    while (high - low > 1) {
+        if (distance2 <= low || distance2 >= high) {
+            distance2 = std::max(low + 1, std::min(high - 1, (int64_t)std::sqrt((double)low * high)));
+        }
+        size_t count = poissonDiskMark(points, distance2, seed, threads, keep);
+        if (count == target) {
+            keepMarkedPoints(points, keep);
+            return std::sqrt((double)distance2);
+        }
+        if (count > target) {
+            low = distance2;
+            lowCount = count;
+            lowKeep.swap(keep);
+        } else {
+            high = distance2;
+        }
+        distance2 = (int64_t)std::llround((double)distance2 * count / target);
+    }
+    if (lowKeep.empty()) poissonDiskMark(points, low, seed, threads, lowKeep);
+
+    // Quitar de la muestra más densa los puntos de peor prioridad
+    std::vector<std::pair<uint64_t, uint32_t>> ranked;
+    ranked.reserve(lowCount);
+    for (size_t i = 0; i < points.size(); i++) {
+        if (lowKeep[i]) ranked.push_back(std::make_pair(samplePriority(points[i], seed), (uint32_t)i));
+    }
+    std::nth_element(ranked.begin(), ranked.begin() + target, ranked.end());
+    for (size_t i = target; i < ranked.size(); i++) lowKeep[ranked[i].second] = 0;
+    keepMarkedPoints(points, lowKeep);
+    return std::sqrt((double)low);
+}
+
+#endif
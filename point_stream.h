@@ -0,0 +1,280 @@
+#ifndef POINT_STREAM_H
+#define POINT_STREAM_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <ostream>
+#include <iostream>
+#include <algorithm>
+#include "byte_codec.h"
+
+// Formato compacto de puntos de borde (.edg). Los puntos llegan agrupados por
+// imagen y en orden raster, así que cada imagen es un bloque y dentro del bloque
+// los puntos se agrupan en filas (misma y) codificadas por diferencias:
+//
+//   archivo  = "EDGP" versión(1) 0 0 0, bloques..., índice, cola
+//   bloque   = varint(zigzag z) varint(puntos) filas...
+//   fila     = varint(zigzag dy) varint(n) n x varint(zigzag dx)
+//   índice   = por bloque: int32 z, uint32 puntos, uint64 desplazamiento
+//   cola     = uint64 desplazamientoÍndice, uint64 totalPuntos, uint32 bloques, "EDGI"
+//
+// dy es relativo a la fila anterior del bloque y dx al punto anterior de la fila
+// (el primero, a 0). Los enteros del índice y la cola son little-endian. El índice
+// va al final para poder escribir el archivo de una vez, sin volver atrás, y
+// permite decodificar una sola imagen. Las coordenadas deben ser enteras.
+
+const char COMPACT_POINTS_MAGIC[4] = { 'E', 'D', 'G', 'P' };
+const char COMPACT_INDEX_MAGIC[4] = { 'E', 'D', 'G', 'I' };
+const size_t COMPACT_HEADER_BYTES = 8;
+const size_t COMPACT_INDEX_ENTRY_BYTES = 16;
+const size_t COMPACT_TRAILER_BYTES = 24;
+
+// Escritor secuencial: cada llamada a writeSlice añade uno o más bloques (uno por
+// cada z distinta, en el orden de llegada) y finish() escribe índice y cola.
+class CompactPointWriter {
+private:
+    struct BlockEntry {
+        int32_t z;
+        uint32_t count;
+        uint64_t offset;
+    };
+
+    std::vector<BlockEntry> index;
+    std::vector<uint8_t> buffer;
+    uint64_t offset = 0;          // Bytes escritos desde el inicio del archivo
+    uint64_t totalPoints = 0;
+    bool failed = false;
+
+    void emit(std::ostream& out) {
+        out.write((const char*)buffer.data(), (std::streamsize)buffer.size());
+        offset += buffer.size();
+        buffer.clear();
+    }
+
+    void writeHeader(std::ostream& out) {
+        buffer.insert(buffer.end(), COMPACT_POINTS_MAGIC, COMPACT_POINTS_MAGIC + 4);
+        buffer.push_back(1);
+        buffer.resize(COMPACT_HEADER_BYTES, 0);
+        emit(out);
+    }
+
+    static bool toInteger(double value, int64_t& result) {
+        if (!(std::fabs(value) < 9e15)) return false;
+        result = (int64_t)value;
+        return (double)result == value;
+    }
+
+    // Codificar los puntos [first, last), todos con la misma z
+    template <typename Point>
+    bool encodeBlock(const std::vector<Point>& points, size_t first, size_t last, int64_t z) {
+        putVarint(buffer, zigzagEncode(z));
+        putVarint(buffer, last - first);
+
+        int64_t previousY = 0;
+        size_t i = first;
+        while (i < last) {
+            int64_t y;
+            if (!toInteger(points[i].y, y)) return false;
+            size_t rowEnd = i + 1;
+            while (rowEnd < last && points[rowEnd].y == points[i].y) rowEnd++;
+
+            putVarint(buffer, zigzagEncode(y - previousY));
+            putVarint(buffer, rowEnd - i);
+            previousY = y;
+
+            int64_t previousX = 0;
+            for (; i < rowEnd; i++) {
+                int64_t x;
+                if (!toInteger(points[i].x, x)) return false;
+                putVarint(buffer, zigzagEncode(x - previousX));
+                previousX = x;
+            }
+        }
+        return true;
+    }
+
+public:
+    template <typename Point>
+    void writeSlice(std::ostream& out, const std::vector<Point>& points) {
+        if (offset == 0) writeHeader(out);
+
+        size_t first = 0;
+        while (first < points.size() && !failed) {
+            int64_t z;
+            size_t last = first + 1;
+            while (last < points.size() && points[last].z == points[first].z) last++;
+
+            if (!toInteger(points[first].z, z) || z < INT32_MIN || z > INT32_MAX ||
+                !encodeBlock(points, first, last, z)) {
+                std::cerr << "Error: El formato compacto solo admite coordenadas enteras" << std::endl;
+                failed = true;
+                buffer.clear();
+                return;
+            }
+            BlockEntry entry = { (int32_t)z, (uint32_t)(last - first), offset };
+            index.push_back(entry);
+            totalPoints += last - first;
+            emit(out);
+            first = last;
+        }
+    }
+
+    // Escribir índice y cola; devuelve false si algún punto no se pudo codificar.
+    // El escritor queda listo para otro archivo.
+    bool finish(std::ostream& out) {
+        if (offset == 0) writeHeader(out);
+        uint64_t indexOffset = offset;
+        for (const BlockEntry& entry : index) {
+            putLE(buffer, (uint32_t)entry.z, 4);
+            putLE(buffer, entry.count, 4);
+            putLE(buffer, entry.offset, 8);
+        }
+        putLE(buffer, indexOffset, 8);
+        putLE(buffer, totalPoints, 8);
+        putLE(buffer, index.size(), 4);
+        buffer.insert(buffer.end(), COMPACT_INDEX_MAGIC, COMPACT_INDEX_MAGIC + 4);
+        emit(out);
+
+        bool ok = !failed;
+        index.clear();
+        offset = totalPoints = 0;
+        failed = false;
+        return ok;
+    }
+};
+
+inline bool isCompactPointFile(const char* data, size_t size) {
+    return size >= COMPACT_HEADER_BYTES && std::memcmp(data, COMPACT_POINTS_MAGIC, 4) == 0;
+}
+
+// Lector sobre un archivo ya en memoria (p. ej. proyectado con mmap): valida la
+// cola y el índice al abrir y decodifica bloques completos o el de una imagen
+class CompactPointReader {
+private:
+    const uint8_t* bytes = nullptr;
+    const uint8_t* indexData = nullptr;
+    size_t numBlocks = 0;
+    uint64_t numPoints = 0;
+
+public:
+    bool open(const char* data, size_t size) {
+        bytes = (const uint8_t*)data;
+        numBlocks = 0;
+        numPoints = 0;
+
+        if (!isCompactPointFile(data, size) || size < COMPACT_HEADER_BYTES + COMPACT_TRAILER_BYTES) {
+            std::cerr << "Error: Archivo compacto inválido" << std::endl;
+            return false;
+        }
+        if (bytes[4] != 1) {
+            std::cerr << "Error: Versión de archivo compacto no soportada: " << (int)bytes[4] << std::endl;
+            return false;
+        }
+        const uint8_t* trailer = bytes + size - COMPACT_TRAILER_BYTES;
+        if (std::memcmp(trailer + 20, COMPACT_INDEX_MAGIC, 4) != 0) {
+            std::cerr << "Error: Archivo compacto incompleto (sin índice)" << std::endl;
+            return false;
+        }
+        uint64_t indexOffset = loadLE(trailer, 8);
+        numPoints = loadLE(trailer + 8, 8);
+        numBlocks = (size_t)loadLE(trailer + 16, 4);
+        if (indexOffset < COMPACT_HEADER_BYTES ||
+            indexOffset + numBlocks * COMPACT_INDEX_ENTRY_BYTES != size - COMPACT_TRAILER_BYTES) {
+            std::cerr << "Error: Índice del archivo compacto dañado" << std::endl;
+            numBlocks = 0;
+            return false;
+        }
+        // Cada punto ocupa al menos un byte: un recuento mayor que los bytes
+        // disponibles es un archivo dañado, no una reserva que intentar
+        if (numPoints > size) {
+            std::cerr << "Error: Archivo compacto dañado (" << numPoints << " puntos en "
+                      << size << " bytes)" << std::endl;
+            numBlocks = 0;
+            return false;
+        }
+        indexData = bytes + indexOffset;
+        for (size_t b = 0; b < numBlocks; b++) {
+            if (blockOffset(b) < COMPACT_HEADER_BYTES || blockOffset(b) >= indexOffset ||
+                blockPoints(b) > indexOffset - blockOffset(b)) {
+                std::cerr << "Error: Índice del archivo compacto dañado" << std::endl;
+                numBlocks = 0;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t blocks() const { return numBlocks; }
+    uint64_t points() const { return numPoints; }
+    int blockZ(size_t b) const { return (int32_t)(uint32_t)loadLE(indexData + b * COMPACT_INDEX_ENTRY_BYTES, 4); }
+    size_t blockPoints(size_t b) const { return (size_t)loadLE(indexData + b * COMPACT_INDEX_ENTRY_BYTES + 4, 4); }
+    uint64_t blockOffset(size_t b) const { return loadLE(indexData + b * COMPACT_INDEX_ENTRY_BYTES + 8, 8); }
+
+    // Bloque de la imagen z, o -1 si no tiene puntos
+    long findBlock(int z) const {
+        for (size_t b = 0; b < numBlocks; b++) {
+            if (blockZ(b) == z) return (long)b;
+        }
+        return -1;
+    }
+
+    // Añadir a 'out' los puntos del bloque b (Point con miembros float x, y, z)
+    template <typename Point>
+    bool decodeBlock(size_t b, std::vector<Point>& out) const {
+        const uint8_t* p = bytes + blockOffset(b);
+        const uint8_t* end = indexData;
+        uint64_t zigzagZ, count;
+        if (!readVarint(p, end, zigzagZ) || !readVarint(p, end, count) || count != blockPoints(b)) {
+            std::cerr << "Error: Bloque " << b << " del archivo compacto dañado" << std::endl;
+            return false;
+        }
+        const float z = (float)zigzagDecode(zigzagZ);
+
+        size_t base = out.size();
+        out.resize(base + count);
+        Point* dst = out.data() + base;
+        int64_t y = 0;
+        uint64_t remaining = count;
+        while (remaining > 0) {
+            uint64_t dy, n;
+            if (!readVarint(p, end, dy) || !readVarint(p, end, n) || n == 0 || n > remaining) {
+                std::cerr << "Error: Bloque " << b << " del archivo compacto dañado" << std::endl;
+                out.resize(base);
+                return false;
+            }
+            y += zigzagDecode(dy);
+            remaining -= n;
+
+            int64_t x = 0;
+            for (; n > 0; n--, dst++) {
+                uint64_t dx;
+                if (p < end && *p < 0x80) {
+                    dx = *p++;       // Caso común: diferencia de un byte
+                } else if (!readVarint(p, end, dx)) {
+                    std::cerr << "Error: Bloque " << b << " del archivo compacto dañado" << std::endl;
+                    out.resize(base);
+                    return false;
+                }
+                x += zigzagDecode(dx);
+                dst->x = (float)x;
+                dst->y = (float)y;
+                dst->z = z;
+            }
+        }
+        return true;
+    }
+
+    template <typename Point>
+    bool decodeAll(std::vector<Point>& out) const {
+        out.clear();
+        out.reserve((size_t)numPoints);
+        for (size_t b = 0; b < numBlocks; b++) {
+            if (!decodeBlock(b, out)) return false;
+        }
+        return true;
+    }
+};
+
+#endif
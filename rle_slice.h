@@ -0,0 +1,159 @@
+#ifndef RLE_SLICE_H
+#define RLE_SLICE_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "bit_volume.h"
+
+// Tramo horizontal de píxeles de objeto: columnas [start, end)
+struct PixelRun {
+    int start;
+    int end;
+    PixelRun(int start = 0, int end = 0) : start(start), end(end) {}
+};
+
+// Imagen binaria codificada por tramos: para cada fila, la lista ordenada de
+// tramos de objeto. Las máscaras de órganos son sobre todo tramos largos, así
+// que la cantidad de tramos crece con el perímetro y no con el área.
+class RleSlice {
+private:
+    std::vector<PixelRun> runs;
+    std::vector<uint32_t> rowStart;   // rows + 1 entradas
+    int numRows = 0;
+    int numCols = 0;
+
+public:
+    // Construir a partir de una imagen empaquetada, detectando las transiciones
+    // 0->1 y 1->0 de cada palabra con conteo de ceros finales. Si se indica la
+    // ocupación, solo se recorren las filas de la caja envolvente.
+    void build(const BitSliceView& slice, const SliceOccupancy* occupancy = nullptr) {
+        numRows = slice.rows;
+        numCols = slice.cols;
+        runs.clear();
+        rowStart.assign(numRows + 1, 0);
+
+        int firstRow = occupancy ? occupancy->minRow : 0;
+        int lastRow = occupancy ? occupancy->maxRow : numRows - 1;
+
+        for (int r = 0; r < numRows; r++) {
+            rowStart[r] = (uint32_t)runs.size();
+            if (r < firstRow || r > lastRow) continue;
+
+            const uint64_t* row = slice.row(r);
+            uint64_t previousBit = 0;
+            int start = 0;
+            bool inRun = false;
+
+            for (int w = 0; w < slice.wordsPerRow; w++) {
+                uint64_t word = row[w];
+                uint64_t transitions = word ^ ((word << 1) | previousBit);
+                previousBit = word >> 63;
+
+                for (; transitions; transitions &= transitions - 1) {
+                    int col = w * 64 + countTrailingZeros(transitions);
+                    if (!inRun) {
+                        start = col;
+                    } else {
+                        runs.push_back(PixelRun(start, col));
+                    }
+                    inRun = !inRun;
+                }
+            }
+            if (inRun) {
+                runs.push_back(PixelRun(start, numCols));
+            }
+        }
+        rowStart[numRows] = (uint32_t)runs.size();
+    }
+
+    int rows() const { return numRows; }
+    int cols() const { return numCols; }
+    size_t runCount() const { return runs.size(); }
+    size_t memoryBytes() const { return runs.capacity() * sizeof(PixelRun) + rowStart.capacity() * sizeof(uint32_t); }
+
+    const PixelRun* rowBegin(int r) const { return runs.data() + rowStart[r]; }
+    const PixelRun* rowEnd(int r) const { return runs.data() + rowStart[r + 1]; }
+};
+
+// Erosión 1D de una lista de tramos: cada tramo pierde una columna por lado.
+// Si 'borderIsObject', los extremos que tocan el borde de la imagen se conservan.
+inline void erodeRuns(const PixelRun* begin, const PixelRun* end, int cols, bool borderIsObject,
+                      std::vector<PixelRun>& out) {
+    out.clear();
+    for (const PixelRun* run = begin; run != end; ++run) {
+        int start = (borderIsObject && run->start == 0) ? 0 : run->start + 1;
+        int stop = (borderIsObject && run->end == cols) ? cols : run->end - 1;
+        if (start < stop) out.push_back(PixelRun(start, stop));
+    }
+}
+
+// Intersección de dos listas ordenadas de tramos
+inline void intersectRuns(const std::vector<PixelRun>& a, const std::vector<PixelRun>& b,
+                          std::vector<PixelRun>& out) {
+    out.clear();
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        int start = std::max(a[i].start, b[j].start);
+        int stop = std::min(a[i].end, b[j].end);
+        if (start < stop) out.push_back(PixelRun(start, stop));
+        if (a[i].end < b[j].end) i++; else j++;
+    }
+}
+
+// Recorrer los píxeles de borde de una imagen por tramos, en orden raster,
+// llamando emit(fila, inicio, fin) por cada tramo de borde [inicio, fin).
+// Un píxel de un tramo es interior si su vecindad 3x3 está cubierta por tramos
+// de las filas de arriba, de abajo y de la propia fila; el borde es el resto
+// del tramo: sus extremos más las partes no cubiertas por las filas vecinas.
+// 'borderIsObject' = false equivale al método manual, true al morfológico.
+template <typename Emit>
+inline void forEachEdgeRun(const RleSlice& slice, bool borderIsObject, Emit emit) {
+    const int rows = slice.rows();
+    const int cols = slice.cols();
+    const PixelRun fullRow(0, cols);
+
+    std::vector<PixelRun> erodedAbove, erodedCur, erodedBelow, partial, interior;
+
+    // Filas fuera de la imagen: vacías (manual) o llenas (morfológico)
+    auto erodeRow = [&](int r, std::vector<PixelRun>& out) {
+        if (r >= 0 && r < rows) {
+            erodeRuns(slice.rowBegin(r), slice.rowEnd(r), cols, borderIsObject, out);
+        } else if (borderIsObject) {
+            erodeRuns(&fullRow, &fullRow + 1, cols, true, out);
+        } else {
+            out.clear();
+        }
+    };
+
+    erodeRow(-1, erodedAbove);
+    erodeRow(0, erodedCur);
+
+    for (int r = 0; r < rows; r++) {
+        erodeRow(r + 1, erodedBelow);
+
+        const PixelRun* begin = slice.rowBegin(r);
+        const PixelRun* end = slice.rowEnd(r);
+        if (begin != end) {
+            intersectRuns(erodedAbove, erodedBelow, partial);
+            intersectRuns(partial, erodedCur, interior);
+
+            // Tramo menos interior, recorriendo ambas listas en orden
+            size_t k = 0;
+            for (const PixelRun* run = begin; run != end; ++run) {
+                int pos = run->start;
+                while (k < interior.size() && interior[k].end <= run->start) k++;
+                for (size_t m = k; m < interior.size() && interior[m].start < run->end; m++) {
+                    if (interior[m].start > pos) emit(r, pos, interior[m].start);
+                    pos = std::max(pos, interior[m].end);
+                }
+                if (pos < run->end) emit(r, pos, run->end);
+            }
+        }
+
+        erodedAbove.swap(erodedCur);
+        erodedCur.swap(erodedBelow);
+    }
+}
+
+#endif
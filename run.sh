@@ -3,4 +3,4 @@
 #sudo apt-get install libopencv-dev
 
 # Compilar
-g++ -std=c++11 -o tiff_extractor main.cpp `pkg-config --cflags --libs opencv4`
\ No newline at end of file
+g++ -std=c++11 -O2 -pthread -o tiff_extractor main.cpp `pkg-config --cflags --libs opencv4`
\ No newline at end of file
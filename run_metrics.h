@@ -0,0 +1,193 @@
+#ifndef RUN_METRICS_H
+#define RUN_METRICS_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <utility>
+
+// Tiempos por fase y contadores de una ejecución (--metrics), en un JSON estable
+// para comparar versiones:
+//
+//   { "metrics_version": 1,
+//     "info": { "input": "...", "mode": "...", ... },
+//     "total_seconds": 1.23,
+//     "phases": { "load": { "seconds": 0.5, "calls": 1 }, ... },
+//     "counters": { "bytes_decoded": 123, ... },
+//     "slices": { "count": 136, "mean_ms": ..., "p50_ms": ..., "p90_ms": ...,
+//                 "p99_ms": ..., "max_ms": ... } }
+//
+// Las fases y contadores salen en el orden en que aparecieron por primera vez.
+// Las fases pueden anidarse (p. ej. "load" incluye "decode" e "index") y una fase
+// medida dentro de los hilos suma el tiempo de todos ellos, así que puede
+// superar el tiempo real. Los percentiles son por rango (nearest-rank)
+// sobre el tiempo de extracción de cada imagen.
+
+class RunMetrics {
+private:
+    struct Phase {
+        double seconds = 0;
+        long long calls = 0;
+    };
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    std::vector<std::pair<std::string, std::string>> info;
+    std::vector<std::pair<std::string, Phase>> phases;
+    std::vector<std::pair<std::string, long long>> counters;
+    std::vector<double> sliceSeconds;
+    std::mutex mutex;
+
+    template <typename T>
+    static T& entry(std::vector<std::pair<std::string, T>>& list, const std::string& name) {
+        for (auto& item : list) {
+            if (item.first == name) return item.second;
+        }
+        list.push_back(std::make_pair(name, T()));
+        return list.back().second;
+    }
+
+    static std::string quote(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if ((unsigned char)c < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)c);
+                out += escaped;
+            } else {
+                out += c;
+            }
+        }
+        return out + "\"";
+    }
+
+    static std::string number(double value) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.6g", value);
+        return text;
+    }
+
+    // Percentil p (0-100) por rango de valores ya ordenados
+    static double percentile(const std::vector<double>& sorted, double p) {
+        size_t rank = (size_t)std::ceil(p / 100 * sorted.size());
+        return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+public:
+    void setInfo(const std::string& name, const std::string& value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        entry(info, name) = value;
+    }
+
+    void addPhase(const std::string& name, double seconds) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Phase& phase = entry(phases, name);
+        phase.seconds += seconds;
+        phase.calls++;
+    }
+
+    void addCounter(const std::string& name, long long value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        entry(counters, name) += value;
+    }
+
+    void addSliceTime(double seconds) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sliceSeconds.push_back(seconds);
+    }
+
+    bool writeJson(const std::string& filename) {
+        std::lock_guard<std::mutex> lock(mutex);
+        double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        std::ofstream out(filename);
+        if (!out.is_open()) {
+            std::cerr << "Error: No se pudo crear el archivo " << filename << std::endl;
+            return false;
+        }
+        out << "{\n  \"metrics_version\": 1,\n  \"info\": {";
+        for (size_t i = 0; i < info.size(); i++) {
+            out << (i ? ",\n    " : "\n    ") << quote(info[i].first) << ": " << quote(info[i].second);
+        }
+        out << (info.empty() ? "},\n" : "\n  },\n");
+        out << "  \"total_seconds\": " << number(total) << ",\n  \"phases\": {";
+        for (size_t i = 0; i < phases.size(); i++) {
+            out << (i ? ",\n    " : "\n    ") << quote(phases[i].first) << ": { \"seconds\": "
+                << number(phases[i].second.seconds) << ", \"calls\": " << phases[i].second.calls << " }";
+        }
+        out << (phases.empty() ? "},\n" : "\n  },\n") << "  \"counters\": {";
+        for (size_t i = 0; i < counters.size(); i++) {
+            out << (i ? ",\n    " : "\n    ") << quote(counters[i].first) << ": " << counters[i].second;
+        }
+        out << (counters.empty() ? "},\n" : "\n  },\n");
+
+        std::vector<double> sorted(sliceSeconds);
+        std::sort(sorted.begin(), sorted.end());
+        out << "  \"slices\": { \"count\": " << sorted.size();
+        if (!sorted.empty()) {
+            double sum = 0;
+            for (double seconds : sorted) sum += seconds;
+            out << ", \"mean_ms\": " << number(sum / sorted.size() * 1000)
+                << ", \"p50_ms\": " << number(percentile(sorted, 50) * 1000)
+                << ", \"p90_ms\": " << number(percentile(sorted, 90) * 1000)
+                << ", \"p99_ms\": " << number(percentile(sorted, 99) * 1000)
+                << ", \"max_ms\": " << number(sorted.back() * 1000);
+        }
+        out << " }\n}\n";
+        out.close();
+        if (!out) {
+            std::cerr << "Error: No se pudo escribir el archivo " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+// Mide el tiempo de un ámbito y lo suma a la fase 'name' al salir de él; sin
+// métricas (nullptr) no hace nada
+class PhaseTimer {
+private:
+    RunMetrics* metrics;
+    const char* name;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    PhaseTimer(RunMetrics* metrics, const char* name) : metrics(metrics), name(name) {
+        if (metrics) start = std::chrono::steady_clock::now();
+    }
+
+    ~PhaseTimer() {
+        if (metrics) {
+            metrics->addPhase(name, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+    }
+};
+
+// Mide la extracción de una imagen para los percentiles por imagen
+class SliceTimer {
+private:
+    RunMetrics* metrics;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit SliceTimer(RunMetrics* metrics) : metrics(metrics) {
+        if (metrics) start = std::chrono::steady_clock::now();
+    }
+
+    ~SliceTimer() {
+        if (metrics) {
+            metrics->addSliceTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef SLICE_CACHE_H
+#define SLICE_CACHE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bit_volume.h"
+#include "byte_codec.h"
+
+// Caché en disco de los puntos extraídos de cada imagen. La clave es un hash de
+// 128 bits del contenido decodificado de la imagen (teselas ocupadas) junto
+// con todo lo que influye en el resultado (método, conectividad, dimensiones y,
+// para la superficie 3D, las imágenes vecinas). Cada entrada es un archivo
+// <clave>.pts en el directorio de la caché:
+//
+//   "EDGC" versión(uint32) puntos(uint32) y por punto x(uint16) y(uint16)
+//
+// todo little-endian. La z no se guarda: es la posición de la imagen en la pila,
+// así que una imagen sin cambios que se movió de posición también se reutiliza.
+// SLICE_CACHE_VERSION se incluye en la clave y debe cambiar si cambian los
+// kernels de borde, el cálculo de la clave o el formato de las entradas.
+
+const char SLICE_CACHE_MAGIC[4] = { 'E', 'D', 'G', 'C' };
+const uint32_t SLICE_CACHE_VERSION = 2;
+const size_t SLICE_CACHE_HEADER_BYTES = 12;
+
+inline uint64_t rotateLeft64(uint64_t x, int bits) {
+    return (x << bits) | (x >> (64 - bits));
+}
+
+// Hash de 128 bits que depende del orden de los valores añadidos: dos cadenas
+// independientes con la ronda de xxHash64 (multiplicar, rotar, multiplicar) y
+// constantes distintas, para que el procesador avance las dos a la vez
+struct SliceKey {
+    uint64_t high = 0x6a09e667f3bcc908ULL;
+    uint64_t low = 0xbb67ae8584caa73bULL;
+
+    void add(uint64_t value) {
+        high = rotateLeft64(high + value * 0xc2b2ae3d27d4eb4fULL, 31) * 0x9e3779b185ebca87ULL;
+        low = rotateLeft64(low + value * 0x165667b19e3779f9ULL, 27) * 0x85ebca77c2b2ae63ULL;
+    }
+
+    void add(const SliceKey& other) {
+        add(other.high);
+        add(other.low);
+    }
+
+    std::string hex() const {
+        char text[33];
+        std::snprintf(text, sizeof(text), "%016llx%016llx", (unsigned long long)high, (unsigned long long)low);
+        return text;
+    }
+};
+
+// Hash del contenido de una imagen empaquetada: el mapa de teselas ocupadas, las
+// filas recorridas y las palabras de esas teselas. Fuera de ellas todas las
+// palabras valen 0, así que identifica la imagen igual que recorrerla entera, con
+// un costo proporcional al área con objeto. El mapa solo fija la franja de
+// TILE_ROWS filas, por eso se incluyen las filas: sin ellas, un objeto movido
+// dentro de la franja daría la misma clave.
+inline SliceKey hashSlice(const BitSliceView& slice, const SliceOccupancy& occupancy) {
+    SliceKey key;
+    key.add((uint64_t)slice.rows << 32 | (uint32_t)slice.cols);
+    for (uint64_t bits : occupancy.tiles) key.add(bits);
+    if (occupancy.empty) return key;
+
+    key.add((uint64_t)(uint32_t)occupancy.minRow << 32 | (uint32_t)occupancy.maxRow);
+
+    for (int r = occupancy.minRow; r <= occupancy.maxRow; r++) {
+        const uint64_t* row = slice.row(r);
+        const uint64_t* tileBits = occupancy.tileRow(r / SliceOccupancy::TILE_ROWS);
+        for (int b = 0; b < occupancy.bitmapWords; b++) {
+            for (uint64_t bits = tileBits[b]; bits; bits &= bits - 1) {
+                key.add(row[b * 64 + countTrailingZeros(bits)]);
+            }
+        }
+    }
+    return key;
+}
+
+class SliceCache {
+private:
+    std::string directory;
+
+    std::string entryPath(const SliceKey& key) const {
+        return directory + "/" + key.hex() + ".pts";
+    }
+
+public:
+    // Usar 'path' como directorio de la caché (se crea si no existe)
+    bool open(const std::string& path) {
+        directory = path;
+        while (directory.size() > 1 && directory.back() == '/') directory.pop_back();
+
+        struct stat st;
+        if (stat(directory.c_str(), &st) != 0 && mkdir(directory.c_str(), 0755) != 0) {
+            std::cerr << "Error: No se pudo crear el directorio de caché " << directory << std::endl;
+            directory.clear();
+            return false;
+        }
+        if (stat(directory.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+            std::cerr << "Error: " << directory << " no es un directorio" << std::endl;
+            directory.clear();
+            return false;
+        }
+        return true;
+    }
+
+    bool enabled() const { return !directory.empty(); }
+
+    // Añadir a 'points' los puntos guardados con la clave 'key', con coordenada z;
+    // false si no hay entrada o está dañada (entonces 'points' no cambia)
+    template <typename Point>
+    bool load(const SliceKey& key, int z, std::vector<Point>& points) const {
+        std::ifstream file(entryPath(key), std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+        std::streamoff size = file.tellg();
+        if (size < (std::streamoff)SLICE_CACHE_HEADER_BYTES) return false;
+
+        std::vector<uint8_t> bytes((size_t)size);
+        file.seekg(0);
+        if (!file.read((char*)bytes.data(), size)) return false;
+
+        uint64_t count = loadLE(bytes.data() + 8, 4);
+        if (std::memcmp(bytes.data(), SLICE_CACHE_MAGIC, 4) != 0 ||
+            loadLE(bytes.data() + 4, 4) != SLICE_CACHE_VERSION ||
+            bytes.size() != SLICE_CACHE_HEADER_BYTES + count * 4) {
+            return false;
+        }
+
+        const uint8_t* src = bytes.data() + SLICE_CACHE_HEADER_BYTES;
+        points.reserve(points.size() + count);
+        for (uint64_t i = 0; i < count; i++, src += 4) {
+            points.push_back(Point((int)loadLE(src, 2), (int)loadLE(src + 2, 2), z));
+        }
+        return true;
+    }
+
+    // Guardar los puntos [begin, end) con la clave 'key'. Se escriben en un archivo
+    // temporal propio de 'writer' y se renombran, así un lector (de este u otro
+    // proceso) nunca ve una entrada a medio escribir.
+    template <typename Point>
+    bool store(const SliceKey& key, const Point* begin, const Point* end, int writer) const {
+        std::vector<uint8_t> bytes(SLICE_CACHE_MAGIC, SLICE_CACHE_MAGIC + 4);
+        putLE(bytes, SLICE_CACHE_VERSION, 4);
+        putLE(bytes, (uint64_t)(end - begin), 4);
+        for (const Point* point = begin; point != end; point++) {
+            putLE(bytes, point->x, 2);
+            putLE(bytes, point->y, 2);
+        }
+
+        std::string path = entryPath(key);
+        std::string temporary = path + "." + std::to_string((long)getpid()) + "." + std::to_string(writer) + ".tmp";
+        std::ofstream file(temporary, std::ios::binary);
+        file.write((const char*)bytes.data(), (std::streamsize)bytes.size());
+        file.close();
+        if (!file || std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef SLICE_CONTOURS_H
+#define SLICE_CONTOURS_H
+
+#include <vector>
+#include <memory>
+#include <istream>
+#include <iostream>
+#include <ostream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+#include <opencv2/imgproc.hpp>
+#include "ascii_writer.h"
+
+// Contornos ordenados de cada imagen (.ctr): en lugar de los píxeles de borde en
+// orden raster, cada imagen se describe como polilíneas cerradas con su jerarquía
+// (contornos exteriores y agujeros), de modo que la unión entre imágenes vecinas
+// puede recorrer los contornos en orden sin reconstruir la conectividad:
+//
+//   # contornos v1
+//   slice <z> <contornos>
+//   contour <id> <padre> outer|hole <puntos>
+//   <x> <y>                      (un punto por línea, en orden a lo largo del contorno)
+//
+// Los identificadores son locales a la imagen y 'padre' es el contorno que lo
+// encierra (-1 si ninguno): un agujero tiene como padre su contorno exterior y un
+// objeto dentro de un agujero, ese agujero. Los contornos son cerrados (el último
+// punto se une con el primero, que no se repite) y pasan por los centros de los
+// píxeles de borde del objeto. Con las coordenadas de la nube de puntos (Y
+// invertida), los exteriores van en sentido antihorario y los agujeros en sentido
+// horario. Se escriben todas las imágenes, también las vacías (0 contornos).
+//
+// Con niveles de detalle, tras la cabecera va "levels <n> <tolerancia_0> ...",
+// cada imagen se escribe una vez por nivel ("slice <z> <contornos> <nivel>") y los
+// contornos de cada nivel están simplificados con Douglas-Peucker con esa
+// tolerancia en píxeles (0 = sin simplificar). Todos los niveles tienen los
+// mismos contornos con los mismos identificadores; solo cambian los puntos, que
+// son un subconjunto de los del contorno completo.
+
+const char CONTOUR_FILE_MAGIC[] = "# contornos v1";
+
+struct SliceContour {
+    std::vector<cv::Point> points;  // Columna y fila de la imagen
+    int parent = -1;
+    bool hole = false;
+};
+
+// Doble del área con signo en coordenadas de imagen (fila hacia abajo)
+inline long long contourArea2(const std::vector<cv::Point>& points) {
+    long long area = 0;
+    for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+        area += (long long)points[j].x * points[i].y - (long long)points[i].x * points[j].y;
+    }
+    return area;
+}
+
+// Seguir los contornos de una imagen binaria (0 / distinto de 0) con toda su
+// jerarquía y orientarlos según el formato .ctr
+inline void traceContours(const cv::Mat& binary, std::vector<SliceContour>& contours) {
+    std::vector<std::vector<cv::Point>> traced;
+    std::vector<cv::Vec4i> hierarchy;
+    cv::findContours(binary, traced, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_NONE);
+
+    contours.resize(traced.size());
+    for (size_t i = 0; i < traced.size(); i++) {
+        SliceContour& contour = contours[i];
+        contour.points.swap(traced[i]);
+        contour.parent = hierarchy[i][3];
+
+        // Los niveles de anidamiento alternan exterior / agujero
+        int depth = 0;
+        for (int p = contour.parent; p >= 0; p = hierarchy[p][3]) depth++;
+        contour.hole = (depth % 2) == 1;
+
+        // Con la fila hacia abajo, antihorario con Y invertida es área negativa;
+        // se invierte el recorrido conservando el punto inicial
+        long long area = contourArea2(contour.points);
+        if (area != 0 && (area < 0) == contour.hole) {
+            std::reverse(contour.points.begin() + 1, contour.points.end());
+        }
+    }
+}
+
+// Escritor de contornos que recibe las imágenes en orden (como StreamingMesher)
+class ContourWriter {
+private:
+    std::unique_ptr<AsciiWriter> out;
+    cv::Mat binary;
+    std::vector<SliceContour> contours;
+    std::vector<cv::Point> simplified;
+    std::vector<double> tolerances;     // Niveles de detalle (vacío: solo contornos completos)
+    std::vector<long long> levelPointCount;
+    long long contourCount = 0;
+    long long holeCount = 0;
+    long long pointCount = 0;
+
+    // Escribir los contornos de la imagen z; 'level' < 0 sin niveles de detalle
+    void writeSlice(int z, int rows, int level, double tolerance) {
+        out->text("slice ");
+        out->integer(z);
+        out->put(' ');
+        out->integer((long long)contours.size());
+        if (level >= 0) {
+            out->put(' ');
+            out->integer(level);
+        }
+        out->put('\n');
+
+        for (size_t i = 0; i < contours.size(); i++) {
+            const SliceContour& contour = contours[i];
+            const std::vector<cv::Point>* points = &contour.points;
+            if (tolerance > 0) {
+                cv::approxPolyDP(contour.points, simplified, tolerance, true);
+                points = &simplified;
+            }
+            if (level >= 0) levelPointCount[level] += (long long)points->size();
+
+            out->text("contour ");
+            out->integer((long long)i);
+            out->put(' ');
+            out->integer(contour.parent);
+            out->text(contour.hole ? " hole " : " outer ");
+            out->integer((long long)points->size());
+            out->put('\n');
+            for (const cv::Point& point : *points) {
+                // Invertir Y como en la nube de puntos
+                out->integer(point.x);
+                out->put(' ');
+                out->integer(rows - point.y);
+                out->put('\n');
+            }
+        }
+    }
+
+public:
+    // Escribir además (o en lugar de los contornos completos) un nivel simplificado
+    // por tolerancia, en el orden indicado; llamar antes de begin()
+    void setLevels(const std::vector<double>& levelTolerances) {
+        tolerances = levelTolerances;
+    }
+
+    void begin(std::ostream& stream) {
+        out.reset(new AsciiWriter(stream));
+        contourCount = holeCount = pointCount = 0;
+        levelPointCount.assign(tolerances.size(), 0);
+        out->text(CONTOUR_FILE_MAGIC);
+        out->put('\n');
+        if (!tolerances.empty()) {
+            out->text("levels ");
+            out->integer((long long)tolerances.size());
+            for (double tolerance : tolerances) {
+                out->put(' ');
+                out->number(tolerance);
+            }
+            out->put('\n');
+        }
+    }
+
+    // Añadir la imagen z (objeto: valor > threshold)
+    void addSlice(const cv::Mat& image, int z, uchar threshold = 127) {
+        cv::threshold(image, binary, threshold, 255, cv::THRESH_BINARY);
+        traceContours(binary, contours);
+
+        if (tolerances.empty()) {
+            writeSlice(z, image.rows, -1, 0);
+        }
+        for (size_t level = 0; level < tolerances.size(); level++) {
+            writeSlice(z, image.rows, (int)level, tolerances[level]);
+        }
+
+        for (const SliceContour& contour : contours) {
+            holeCount += contour.hole ? 1 : 0;
+            pointCount += (long long)contour.points.size();
+        }
+        contourCount += (long long)contours.size();
+    }
+
+    void finish() {
+        out->flush();
+    }
+
+    long long contourTotal() const { return contourCount; }
+    long long holes() const { return holeCount; }
+    long long points() const { return pointCount; }     // Puntos de los contornos completos
+    int levels() const { return (int)tolerances.size(); }
+    double levelTolerance(int level) const { return tolerances[level]; }
+    long long levelPoints(int level) const { return levelPointCount[level]; }
+};
+
+inline bool isContourFile(const char* data, size_t size) {
+    size_t length = std::strlen(CONTOUR_FILE_MAGIC);
+    return size >= length && std::memcmp(data, CONTOUR_FILE_MAGIC, length) == 0;
+}
+
+// Leer como nube de puntos (x y z) los contornos de un archivo .ctr: los del nivel
+// 'level' si el archivo tiene niveles de detalle (-1 = el último, el más simplificado)
+template <typename Point>
+inline bool loadContourPoints(std::istream& in, int level, std::vector<Point>& points) {
+    std::string line, word;
+    int levels = 0;
+    int z = 0;
+    bool selected = true;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        if (line.compare(0, 7, "levels ") == 0) {
+            fields >> word >> levels;
+            if (level < 0) level = levels - 1;
+            if (level >= levels) {
+                std::cerr << "Error: El archivo de contornos tiene " << levels << " niveles" << std::endl;
+                return false;
+            }
+        } else if (line.compare(0, 6, "slice ") == 0) {
+            int count, sliceLevel = -1;
+            fields >> word >> z >> count >> sliceLevel;
+            selected = levels == 0 || sliceLevel == level;
+        } else if (selected && line.compare(0, 8, "contour ") != 0) {
+            float x, y;
+            if (fields >> x >> y) points.push_back(Point(x, y, (float)z));
+        }
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,656 @@
+#ifndef TIFF_READER_H
+#define TIFF_READER_H
+
+#include <iostream>
+#include <vector>
+#include <fstream>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <sys/stat.h>
+#include <opencv2/opencv.hpp>
+#include "edge_kernels.h"
+
+// Descripción de una página (IFD) de un archivo TIFF
+struct TiffPageInfo {
+    uint32_t ifdOffset = 0;
+    uint32_t nextIfdOffset = 0;
+    int width = 0;
+    int height = 0;
+    int bitsPerSample = 1;
+    int samplesPerPixel = 1;
+    int compression = 1;       // 1 = sin compresión, 5 = LZW, 32773 = PackBits
+    int photometric = 1;       // 0 = WhiteIsZero, 1 = BlackIsZero
+    int predictor = 1;
+    int fillOrder = 1;
+    int planarConfig = 1;
+    int rowsPerStrip = 0;
+    bool tiled = false;
+    std::vector<uint32_t> stripOffsets;
+    std::vector<uint32_t> stripByteCounts;
+
+    // Bytes de los datos de la página tal como están en el archivo
+    long long storedBytes() const {
+        long long bytes = 0;
+        for (uint32_t count : stripByteCounts) bytes += count;
+        return bytes;
+    }
+
+    // Bytes de la página sin comprimir, con su profundidad de bits original
+    long long decodedBytes() const {
+        return ((long long)width * bitsPerSample * samplesPerPixel + 7) / 8 * height;
+    }
+};
+
+// Lector de TIFF multipágina que decodifica una página a la vez.
+// Solo mantiene en memoria los datos de la página actual, de modo que
+// el consumo no depende de la profundidad de la pila.
+class TiffPageReader {
+private:
+    std::ifstream file;
+    std::string filename;
+    bool bigEndian = false;
+    uint32_t firstIfdOffset = 0;
+    uint32_t nextIfdOffset = 0;
+    int pagesRead = 0;
+    TiffPageInfo lastPage;     // Descripción de la última página decodificada
+
+    // Índice de páginas: desplazamiento del IFD de cada página
+    std::vector<uint32_t> pageOffsets;
+
+    // Buffers reutilizados entre páginas
+    std::vector<uint8_t> compressed;
+    std::vector<uint8_t> decoded;
+
+    uint16_t readU16(const uint8_t* p) const {
+        return bigEndian ? (uint16_t)((p[0] << 8) | p[1]) : (uint16_t)(p[0] | (p[1] << 8));
+    }
+
+    uint32_t readU32(const uint8_t* p) const {
+        return bigEndian ? ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]
+                         : p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    bool readBytes(uint32_t offset, void* dst, size_t count) {
+        file.clear();
+        file.seekg(offset);
+        file.read(static_cast<char*>(dst), count);
+        return (size_t)file.gcount() == count;
+    }
+
+    // Leer los valores (SHORT o LONG) de una entrada del IFD
+    bool readTagValues(const uint8_t* entry, std::vector<uint32_t>& values) {
+        uint16_t type = readU16(entry + 2);
+        uint32_t count = readU32(entry + 4);
+        size_t size = (type == 3) ? 2 : (type == 4) ? 4 : 0;
+        if (size == 0 || count == 0) return false;
+
+        std::vector<uint8_t> raw(size * count);
+        if (size * count <= 4) {
+            std::memcpy(raw.data(), entry + 8, size * count);
+        } else if (!readBytes(readU32(entry + 8), raw.data(), raw.size())) {
+            return false;
+        }
+
+        values.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            values[i] = (size == 2) ? readU16(&raw[i * 2]) : readU32(&raw[i * 4]);
+        }
+        return true;
+    }
+
+    // Descompresión LZW (variante TIFF, MSB primero, cambio de ancho anticipado)
+    static bool decodeLzw(const uint8_t* src, size_t srcLen, uint8_t* dst, size_t dstLen) {
+        static const int MAX_CODES = 4096;
+        uint16_t prefix[MAX_CODES];
+        uint16_t length[MAX_CODES];
+        uint8_t suffix[MAX_CODES];
+        uint8_t firstChar[MAX_CODES];
+
+        for (int i = 0; i < 256; i++) {
+            prefix[i] = 0;
+            length[i] = 1;
+            suffix[i] = (uint8_t)i;
+            firstChar[i] = (uint8_t)i;
+        }
+
+        int nextCode = 258;
+        int width = 9;
+        int prev = -1;
+        size_t pos = 0, in = 0;
+        uint32_t bitBuffer = 0;
+        int bitCount = 0;
+
+        while (pos < dstLen) {
+            while (bitCount < width) {
+                if (in >= srcLen) return false;
+                bitBuffer = (bitBuffer << 8) | src[in++];
+                bitCount += 8;
+            }
+            int code = (bitBuffer >> (bitCount - width)) & ((1 << width) - 1);
+            bitCount -= width;
+
+            if (code == 257) break;             // EOI
+            if (code == 256) {                  // Clear
+                nextCode = 258;
+                width = 9;
+                prev = -1;
+                continue;
+            }
+
+            if (prev < 0) {
+                if (code > 255) return false;
+                dst[pos++] = (uint8_t)code;
+                prev = code;
+                continue;
+            }
+
+            if (code > nextCode || code >= MAX_CODES) return false;
+            uint8_t first = (code < nextCode) ? firstChar[code] : firstChar[prev];
+
+            if (nextCode < MAX_CODES) {
+                prefix[nextCode] = (uint16_t)prev;
+                suffix[nextCode] = first;
+                firstChar[nextCode] = firstChar[prev];
+                length[nextCode] = length[prev] + 1;
+                nextCode++;
+                if (nextCode + 1 >= (1 << width) && width < 12) width++;
+            }
+
+            // Escribir la cadena del código recorriendo la cadena de prefijos hacia atrás
+            int len = length[code];
+            int c = code;
+            for (int k = len - 1; k >= 0; k--) {
+                if (pos + k < dstLen) dst[pos + k] = suffix[c];
+                c = prefix[c];
+            }
+            pos += len;
+            prev = code;
+        }
+        return true;
+    }
+
+    static bool decodePackBits(const uint8_t* src, size_t srcLen, uint8_t* dst, size_t dstLen) {
+        size_t in = 0, pos = 0;
+        while (pos < dstLen && in < srcLen) {
+            int8_t n = (int8_t)src[in++];
+            if (n >= 0) {
+                size_t count = std::min((size_t)n + 1, dstLen - pos);
+                if (in + count > srcLen) return false;
+                std::memcpy(dst + pos, src + in, count);
+                in += (size_t)n + 1;
+                pos += count;
+            } else if (n != -128) {
+                if (in >= srcLen) return false;
+                size_t count = std::min((size_t)(1 - n), dstLen - pos);
+                std::memset(dst + pos, src[in++], count);
+                pos += count;
+            }
+        }
+        return pos == dstLen;
+    }
+
+    // Tabla de inversión de bits: TIFF guarda el primer píxel en el bit más alto
+    // de cada byte y las filas empaquetadas en el bit más bajo
+    static const uint8_t* bitReverseTable() {
+        struct Table {
+            uint8_t values[256];
+            Table() {
+                for (int i = 0; i < 256; i++) {
+                    uint8_t r = 0;
+                    for (int b = 0; b < 8; b++) r |= ((i >> b) & 1) << (7 - b);
+                    values[i] = r;
+                }
+            }
+        };
+        static const Table table;
+        return table.values;
+    }
+
+    static size_t rowBytesOf(const TiffPageInfo& info) {
+        return (info.bitsPerSample == 1) ? (info.width + 7) / 8 : (size_t)info.width * ((info.bitsPerSample + 7) / 8);
+    }
+
+    // Descomprimir las tiras de la página en 'decoded' (muestras crudas por fila)
+    bool decodeSamples(const TiffPageInfo& info) {
+        if (!isSupported(info)) {
+            std::cerr << "Error: Página TIFF con formato no soportado por el lector por páginas "
+                      << "(bps=" << info.bitsPerSample << ", compresión=" << info.compression << ")" << std::endl;
+            return false;
+        }
+
+        const int bytesPerSample = (info.bitsPerSample + 7) / 8;
+        const size_t rowBytes = rowBytesOf(info);
+        decoded.assign(rowBytes * info.height, 0);
+
+        for (size_t s = 0; s < info.stripOffsets.size(); s++) {
+            size_t firstRow = s * info.rowsPerStrip;
+            if (firstRow >= (size_t)info.height) break;
+            size_t stripRows = std::min((size_t)info.rowsPerStrip, info.height - firstRow);
+            uint8_t* dst = &decoded[firstRow * rowBytes];
+            size_t dstLen = stripRows * rowBytes;
+
+            compressed.resize(info.stripByteCounts[s]);
+            if (!readBytes(info.stripOffsets[s], compressed.data(), compressed.size())) {
+                std::cerr << "Error: Datos de tira truncados en " << filename << std::endl;
+                return false;
+            }
+
+            bool ok = true;
+            if (info.compression == 1) {
+                std::memcpy(dst, compressed.data(), std::min(dstLen, compressed.size()));
+            } else if (info.compression == 5) {
+                ok = decodeLzw(compressed.data(), compressed.size(), dst, dstLen);
+            } else {
+                ok = decodePackBits(compressed.data(), compressed.size(), dst, dstLen);
+            }
+            if (!ok) {
+                std::cerr << "Error: No se pudo descomprimir la tira " << s << " de " << filename << std::endl;
+                return false;
+            }
+        }
+
+        // Predictor horizontal (diferencias por fila)
+        if (info.predictor == 2) {
+            for (int row = 0; row < info.height; row++) {
+                uint8_t* p = &decoded[row * rowBytes];
+                if (bytesPerSample == 1) {
+                    for (int col = 1; col < info.width; col++) p[col] += p[col - 1];
+                } else {
+                    uint16_t prev = readU16(p);
+                    for (int col = 1; col < info.width; col++) {
+                        uint16_t value = (uint16_t)(prev + readU16(p + col * 2));
+                        p[col * 2] = bigEndian ? (uint8_t)(value >> 8) : (uint8_t)value;
+                        p[col * 2 + 1] = bigEndian ? (uint8_t)value : (uint8_t)(value >> 8);
+                        prev = value;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    bool isSupported(const TiffPageInfo& info) const {
+        if (info.tiled || info.samplesPerPixel != 1 || info.planarConfig != 1) return false;
+        if (info.bitsPerSample != 1 && info.bitsPerSample != 8 && info.bitsPerSample != 16) return false;
+        if (info.compression != 1 && info.compression != 5 && info.compression != 32773) return false;
+        if (info.predictor != 1 && !(info.predictor == 2 && info.bitsPerSample > 1)) return false;
+        if (info.fillOrder != 1 || info.photometric > 1) return false;
+        return info.width > 0 && info.height > 0 && !info.stripOffsets.empty() &&
+               info.stripOffsets.size() == info.stripByteCounts.size();
+    }
+
+public:
+    bool open(const std::string& path) {
+        close();
+        filename = path;
+        file.open(path, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: No se pudo abrir el archivo " << path << std::endl;
+            return false;
+        }
+
+        uint8_t header[8];
+        if (!readBytes(0, header, sizeof(header))) {
+            std::cerr << "Error: Cabecera TIFF incompleta en " << path << std::endl;
+            return false;
+        }
+        if (header[0] == 'I' && header[1] == 'I') bigEndian = false;
+        else if (header[0] == 'M' && header[1] == 'M') bigEndian = true;
+        else {
+            std::cerr << "Error: " << path << " no es un archivo TIFF" << std::endl;
+            return false;
+        }
+        if (readU16(header + 2) != 42) {
+            std::cerr << "Error: Formato TIFF no soportado (BigTIFF u otro) en " << path << std::endl;
+            return false;
+        }
+
+        firstIfdOffset = readU32(header + 4);
+        rewind();
+        return true;
+    }
+
+    void close() {
+        if (file.is_open()) file.close();
+        firstIfdOffset = nextIfdOffset = 0;
+        pagesRead = 0;
+        pageOffsets.clear();
+    }
+
+    // Volver a la primera página
+    void rewind() {
+        nextIfdOffset = firstIfdOffset;
+        pagesRead = 0;
+    }
+
+    bool hasNextPage() const { return nextIfdOffset != 0; }
+    int pagesConsumed() const { return pagesRead; }
+    const std::string& path() const { return filename; }
+
+    // Leer y analizar el IFD ubicado en 'offset'
+    bool readPageInfo(uint32_t offset, TiffPageInfo& info) {
+        info = TiffPageInfo();
+        info.ifdOffset = offset;
+
+        uint8_t countBytes[2];
+        if (!readBytes(offset, countBytes, 2)) return false;
+        uint16_t entryCount = readU16(countBytes);
+
+        std::vector<uint8_t> entries(entryCount * 12 + 4);
+        if (!readBytes(offset + 2, entries.data(), entries.size())) return false;
+
+        for (int i = 0; i < entryCount; i++) {
+            const uint8_t* entry = &entries[i * 12];
+            uint16_t tag = readU16(entry);
+            std::vector<uint32_t> values;
+
+            switch (tag) {
+                case 256: if (readTagValues(entry, values)) info.width = values[0]; break;
+                case 257: if (readTagValues(entry, values)) info.height = values[0]; break;
+                case 258: if (readTagValues(entry, values)) info.bitsPerSample = values[0]; break;
+                case 259: if (readTagValues(entry, values)) info.compression = values[0]; break;
+                case 262: if (readTagValues(entry, values)) info.photometric = values[0]; break;
+                case 266: if (readTagValues(entry, values)) info.fillOrder = values[0]; break;
+                case 273: readTagValues(entry, info.stripOffsets); break;
+                case 277: if (readTagValues(entry, values)) info.samplesPerPixel = values[0]; break;
+                case 278: if (readTagValues(entry, values)) info.rowsPerStrip = values[0]; break;
+                case 279: readTagValues(entry, info.stripByteCounts); break;
+                case 284: if (readTagValues(entry, values)) info.planarConfig = values[0]; break;
+                case 317: if (readTagValues(entry, values)) info.predictor = values[0]; break;
+                case 322: case 323: case 324: case 325: info.tiled = true; break;
+                default: break;
+            }
+        }
+
+        info.nextIfdOffset = readU32(&entries[entryCount * 12]);
+        if (info.rowsPerStrip <= 0 || info.rowsPerStrip > info.height) info.rowsPerStrip = info.height;
+        return true;
+    }
+
+    // Decodificar una página ya descrita. Con IMREAD_GRAYSCALE el resultado
+    // es CV_8U (las muestras de 1 bit quedan como 0/255, igual que cv::imreadmulti);
+    // con IMREAD_UNCHANGED las páginas de 16 bits se devuelven como CV_16U.
+    bool decodePage(const TiffPageInfo& info, cv::Mat& out, int flags = cv::IMREAD_GRAYSCALE) {
+        if (!decodeSamples(info)) {
+            return false;
+        }
+
+        const size_t rowBytes = rowBytesOf(info);
+        const bool invert = (info.photometric == 0);
+
+        if (info.bitsPerSample == 16 && flags != cv::IMREAD_GRAYSCALE) {
+            out.create(info.height, info.width, CV_16UC1);
+            for (int row = 0; row < info.height; row++) {
+                const uint8_t* src = &decoded[row * rowBytes];
+                uint16_t* dst = out.ptr<uint16_t>(row);
+                for (int col = 0; col < info.width; col++) {
+                    uint16_t value = readU16(src + col * 2);
+                    dst[col] = invert ? (uint16_t)(0xFFFF - value) : value;
+                }
+            }
+            return true;
+        }
+
+        out.create(info.height, info.width, CV_8UC1);
+        for (int row = 0; row < info.height; row++) {
+            const uint8_t* src = &decoded[row * rowBytes];
+            uchar* dst = out.ptr<uchar>(row);
+
+            if (info.bitsPerSample == 1) {
+                const uchar on = invert ? 0 : 255;
+                const uchar off = invert ? 255 : 0;
+                for (int col = 0; col < info.width; col++) {
+                    dst[col] = ((src[col >> 3] >> (7 - (col & 7))) & 1) ? on : off;
+                }
+            } else if (info.bitsPerSample == 8) {
+                for (int col = 0; col < info.width; col++) {
+                    dst[col] = invert ? (uchar)(255 - src[col]) : src[col];
+                }
+            } else {
+                // 16 bits a 8 bits, como hace IMREAD_GRAYSCALE
+                for (int col = 0; col < info.width; col++) {
+                    uint16_t value = readU16(src + col * 2);
+                    if (invert) value = (uint16_t)(0xFFFF - value);
+                    dst[col] = (uchar)(value >> 8);
+                }
+            }
+        }
+        return true;
+    }
+
+    // Decodificar una página directamente a filas binarias empaquetadas (ver
+    // edge_kernels.h), sin pasar por una imagen de 8 bits. Se aplica el mismo
+    // umbral que cv::threshold(127) sobre la imagen en escala de grises.
+    bool decodePageBits(const TiffPageInfo& info, uint64_t* dst, int wordsPerRow) {
+        if (!decodeSamples(info)) {
+            return false;
+        }
+
+        const uint8_t* reversed = bitReverseTable();
+        const size_t rowBytes = rowBytesOf(info);
+        const int words = packedWords(info.width);
+        const uint64_t lastMask = lastWordMask(info.width);
+        const bool invert = (info.photometric == 0);
+        std::vector<uchar> gray;
+
+        for (int row = 0; row < info.height; row++) {
+            const uint8_t* src = &decoded[row * rowBytes];
+            uint64_t* out = dst + (size_t)row * wordsPerRow;
+
+            if (info.bitsPerSample == 1) {
+                for (int w = 0; w < words; w++) {
+                    uint64_t word = 0;
+                    for (int k = 0; k < 8 && (size_t)(w * 8 + k) < rowBytes; k++) {
+                        word |= (uint64_t)reversed[src[w * 8 + k]] << (8 * k);
+                    }
+                    out[w] = invert ? ~word : word;
+                }
+            } else if (info.bitsPerSample == 8) {
+                if (invert) {
+                    gray.resize(info.width);
+                    for (int col = 0; col < info.width; col++) gray[col] = (uchar)(255 - src[col]);
+                    packRow(gray.data(), info.width, out, 127);
+                } else {
+                    packRow(src, info.width, out, 127);
+                }
+            } else {
+                for (int w = 0; w < words; w++) out[w] = 0;
+                for (int col = 0; col < info.width; col++) {
+                    uint16_t value = readU16(src + col * 2);
+                    if (invert) value = (uint16_t)(0xFFFF - value);
+                    if ((value >> 8) > 127) out[col >> 6] |= 1ULL << (col & 63);
+                }
+            }
+            out[words - 1] &= lastMask;
+        }
+        return true;
+    }
+
+    // Comprobar si el lector por páginas puede decodificar esta página
+    bool canDecode(const TiffPageInfo& info) const {
+        return isSupported(info);
+    }
+
+    // Ruta del índice persistente asociado a un TIFF
+    static std::string indexPathFor(const std::string& tiffPath) {
+        return tiffPath + ".idx";
+    }
+
+    bool hasIndex() const { return !pageOffsets.empty(); }
+    int pageCount() const { return (int)pageOffsets.size(); }
+
+    // Construir el índice recorriendo solo la cadena de IFDs (sin decodificar píxeles)
+    bool buildIndex() {
+        pageOffsets.clear();
+        uint32_t offset = firstIfdOffset;
+
+        while (offset != 0) {
+            uint8_t countBytes[2];
+            if (!readBytes(offset, countBytes, 2)) break;
+            uint16_t entryCount = readU16(countBytes);
+
+            uint8_t next[4];
+            if (!readBytes(offset + 2 + entryCount * 12, next, 4)) break;
+
+            pageOffsets.push_back(offset);
+            offset = readU32(next);
+
+            // Protección contra cadenas de IFD circulares
+            if (pageOffsets.size() > 1000000) {
+                std::cerr << "Error: Cadena de IFDs inválida en " << filename << std::endl;
+                pageOffsets.clear();
+                return false;
+            }
+        }
+
+        if (pageOffsets.empty()) {
+            std::cerr << "Error: No se encontraron páginas en " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Cargar un índice guardado; se descarta si el TIFF cambió de tamaño o fecha
+    bool loadIndex(const std::string& indexPath) {
+        struct stat st;
+        if (stat(filename.c_str(), &st) != 0) return false;
+
+        std::ifstream in(indexPath);
+        if (!in.is_open()) return false;
+
+        std::string line, key;
+        long long size = -1, mtime = -1;
+        int pages = -1;
+        std::getline(in, line);
+        if (line != "# tiff-page-index v1") return false;
+        if (!(in >> key >> size) || key != "size") return false;
+        if (!(in >> key >> mtime) || key != "mtime") return false;
+        if (!(in >> key >> pages) || key != "pages" || pages <= 0) return false;
+        if (size != (long long)st.st_size || mtime != (long long)st.st_mtime) return false;
+
+        std::vector<uint32_t> offsets(pages);
+        for (int i = 0; i < pages; i++) {
+            if (!(in >> offsets[i])) return false;
+        }
+        if (offsets[0] != firstIfdOffset) return false;
+
+        pageOffsets.swap(offsets);
+        return true;
+    }
+
+    bool saveIndex(const std::string& indexPath) const {
+        struct stat st;
+        if (pageOffsets.empty() || stat(filename.c_str(), &st) != 0) return false;
+
+        std::ofstream out(indexPath);
+        if (!out.is_open()) {
+            std::cerr << "Aviso: No se pudo guardar el índice de páginas en " << indexPath << std::endl;
+            return false;
+        }
+
+        out << "# tiff-page-index v1\n";
+        out << "size " << (long long)st.st_size << "\n";
+        out << "mtime " << (long long)st.st_mtime << "\n";
+        out << "pages " << pageOffsets.size() << "\n";
+        for (uint32_t offset : pageOffsets) {
+            out << offset << "\n";
+        }
+        return true;
+    }
+
+    // Obtener el índice de páginas: si 'persist' es verdadero se reutiliza el
+    // guardado junto al TIFF (o se crea si no existe o está desactualizado)
+    bool openIndex(bool persist) {
+        if (persist && loadIndex(indexPathFor(filename))) {
+            std::cout << "Índice de páginas cargado: " << indexPathFor(filename) << std::endl;
+            return true;
+        }
+        if (!buildIndex()) return false;
+        if (persist && saveIndex(indexPathFor(filename))) {
+            std::cout << "Índice de páginas guardado: " << indexPathFor(filename) << std::endl;
+        }
+        return true;
+    }
+
+    // Reutilizar el índice ya construido por otro lector del mismo archivo
+    void copyIndexFrom(const TiffPageReader& other) {
+        pageOffsets = other.pageOffsets;
+    }
+
+    // Posicionar el lector en una página concreta (requiere índice)
+    bool seekPage(int index) {
+        if (index < 0 || index >= pageCount()) return false;
+        nextIfdOffset = pageOffsets[index];
+        pagesRead = index;
+        return true;
+    }
+
+    // Leer la descripción de la página 'index' (requiere índice)
+    bool pageInfo(int index, TiffPageInfo& info) {
+        if (index < 0 || index >= pageCount()) return false;
+        return readPageInfo(pageOffsets[index], info);
+    }
+
+    // Decodificar la página 'index' a filas empaquetadas (requiere índice)
+    bool readPageBits(int index, uint64_t* dst, int wordsPerRow) {
+        TiffPageInfo info;
+        if (!pageInfo(index, info)) {
+            std::cerr << "Error: Página " << index << " fuera de rango en " << filename << std::endl;
+            return false;
+        }
+        return decodePageBits(info, dst, wordsPerRow);
+    }
+
+    // Decodificar directamente la página 'index' (requiere índice)
+    bool readPage(int index, cv::Mat& out, int flags = cv::IMREAD_GRAYSCALE) {
+        if (!seekPage(index)) {
+            std::cerr << "Error: Página " << index << " fuera de rango en " << filename << std::endl;
+            return false;
+        }
+        return readNextPage(out, flags);
+    }
+
+    // Avanzar a la siguiente página leyendo solo su IFD, sin decodificar los píxeles
+    bool skipPage() {
+        if (!hasNextPage()) return false;
+
+        TiffPageInfo info;
+        if (!readPageInfo(nextIfdOffset, info)) {
+            std::cerr << "Error: IFD corrupto en la página " << pagesRead << " de " << filename << std::endl;
+            nextIfdOffset = 0;
+            return false;
+        }
+
+        nextIfdOffset = info.nextIfdOffset;
+        pagesRead++;
+        return true;
+    }
+
+    // Decodificar la siguiente página de la cadena de IFDs
+    bool readNextPage(cv::Mat& out, int flags = cv::IMREAD_GRAYSCALE) {
+        if (!hasNextPage()) return false;
+
+        TiffPageInfo info;
+        if (!readPageInfo(nextIfdOffset, info)) {
+            std::cerr << "Error: IFD corrupto en la página " << pagesRead << " de " << filename << std::endl;
+            nextIfdOffset = 0;
+            return false;
+        }
+        if (!decodePage(info, out, flags)) {
+            nextIfdOffset = 0;
+            return false;
+        }
+
+        nextIfdOffset = info.nextIfdOffset;
+        pagesRead++;
+        lastPage = info;
+        return true;
+    }
+
+    const TiffPageInfo& lastPageInfo() const {
+        return lastPage;
+    }
+};
+
+#endif
@@ -3,5 +3,5 @@
 #sudo apt-get install libglfw3-dev libglew-dev libglm-dev libopencv-dev
 
 # Compilar
-g++ -std=c++11 -o visualizador visualizador.cpp \
+g++ -std=c++11 -pthread -o visualizador visualizador.cpp \
     -lglfw -lGL -lGLEW `pkg-config --cflags --libs opencv4`
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <cmath>
 #include <algorithm>
 #include <set>
+#include <cstdlib>
 
 // OpenGL
 #include <GL/glew.h>
@@ -17,6 +18,11 @@
 // OpenCV
 #include <opencv2/opencv.hpp>
 
+#include "point_cloud_io.h"
+#include "point_stream.h"
+#include "octree_codec.h"
+#include "slice_contours.h"
+
 struct Point3D {
     float x, y, z;
     Point3D(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
@@ -618,14 +624,83 @@ public:
         return true;
     }
     
-    bool loadPointsFromFile(const std::string& filename) {
+    bool loadPointsFromFile(const std::string& filename, int contourLevel = -1) {
+        // Los archivos binarios (.oct, .edg, PLY/PCD) se proyectan en memoria y se leen sin interpretar texto
+        MappedFile mapped;
+        if (!mapped.open(filename)) {
+            std::cerr << "Error abriendo archivo: " << filename << std::endl;
+            return false;
+        }
+        
+        points.clear();
+        if (isOctreeFile(mapped.data(), mapped.size())) {
+            // Octree comprimido (.oct): un subárbol por tarea, con todos los núcleos
+            int threads = (int)std::thread::hardware_concurrency();
+            if (!decodeOctree(mapped.data(), mapped.size(), points, threads)) {
+                std::cerr << "Error leyendo el octree: " << filename << std::endl;
+                return false;
+            }
+            mapped.close();
+            
+            std::cout << "Puntos cargados (octree): " << points.size() << std::endl;
+            calculateBounds();
+            
+            return !points.empty();
+        }
+        
+        if (isCompactPointFile(mapped.data(), mapped.size())) {
+            // Formato compacto del extractor (.edg): se decodifica bloque a bloque
+            CompactPointReader reader;
+            if (!reader.open(mapped.data(), mapped.size()) || !reader.decodeAll(points)) {
+                std::cerr << "Error leyendo el archivo compacto: " << filename << std::endl;
+                return false;
+            }
+            mapped.close();
+            
+            std::cout << "Puntos cargados (compacto): " << points.size() << std::endl;
+            calculateBounds();
+            
+            return !points.empty();
+        }
+        
+        if (isContourFile(mapped.data(), mapped.size())) {
+            // Contornos ordenados (.ctr): los puntos de los contornos de un nivel de detalle
+            mapped.close();
+            std::ifstream file(filename);
+            if (!loadContourPoints(file, contourLevel, points)) {
+                std::cerr << "Error leyendo el archivo de contornos: " << filename << std::endl;
+                return false;
+            }
+            
+            std::cout << "Puntos cargados (contornos): " << points.size() << std::endl;
+            calculateBounds();
+            
+            return !points.empty();
+        }
+        
+        PointFileLayout layout;
+        if (!parsePointFileLayout(mapped.data(), mapped.size(), layout)) {
+            std::cerr << "Error leyendo la cabecera de: " << filename << std::endl;
+            return false;
+        }
+        
+        if (layout.format != PointFileFormat::Ascii) {
+            loadBinaryPoints(mapped.data(), layout, points);
+            mapped.close();
+            
+            std::cout << "Puntos cargados (binario): " << points.size() << std::endl;
+            calculateBounds();
+            
+            return !points.empty();
+        }
+        mapped.close();
+        
         std::ifstream file(filename);
         if (!file.is_open()) {
             std::cerr << "Error abriendo archivo: " << filename << std::endl;
             return false;
         }
         
-        points.clear();
         std::string line;
         
         // Detectar formato del archivo
@@ -867,8 +942,11 @@ public:
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cout << "Uso: " << argv[0] << " <archivo_puntos>" << std::endl;
-        std::cout << "Formatos soportados: .ply, .xyz, .pcd" << std::endl;
+        std::cout << "Uso: " << argv[0] << " <archivo_puntos> [nivel_contornos]" << std::endl;
+        std::cout << "Formatos soportados: .xyz, .ply y .pcd (ASCII o binarios), .edg (compacto), "
+                  << ".oct (octree) y .ctr (contornos)" << std::endl;
+        std::cout << "  nivel_contornos - Con un .ctr con niveles de detalle, el nivel a mostrar desde 0 "
+                  << "(por defecto el último, el más simplificado)" << std::endl;
         return -1;
     }
     
@@ -881,7 +959,7 @@ int main(int argc, char* argv[]) {
     }
     
     // Cargar puntos
-    if (!visualizer.loadPointsFromFile(argv[1])) {
+    if (!visualizer.loadPointsFromFile(argv[1], argc >= 3 ? std::atoi(argv[2]) : -1)) {
         std::cerr << "Error cargando archivo de puntos" << std::endl;
         return -1;
     }